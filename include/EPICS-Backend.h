@@ -8,6 +8,9 @@
  *      Author: Klaus Zenker (HZDR)
  */
 
+#include "EPICSChannelManager.h"
+#include "EPICSMetadataCache.h"
+#include "EPICSPutTracker.h"
 #include "EPICSRegisterInfo.h"
 #include "EPICSTypes.h"
 
@@ -19,7 +22,10 @@
 #include <string.h>
 
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace ChimeraTK {
 
@@ -32,12 +38,87 @@ namespace ChimeraTK {
     std::atomic<bool> _asyncReadActivated{false};
     std::atomic<bool> _channelAccessUp{false};
 
-    EpicsBackend(const std::string& mapfile = "");
+    /**
+     * Constructor.
+     *
+     * \param mapfile The map file connecting register paths and EPICS channel access names.
+     * \param parameters Additional CDD parameters:
+     *                   - writeMode: Default write mode of all registers, "sync" (default), "confirmed" or "async"
+     *                     (see EpicsWriteMode).
+     *                   - maxPendingWrites: Maximum number of asynchronous writes in flight (default 100).
+     *                   - cachedReadMaxAge: Enables synchronous reads from the last monitored value. The value is
+     *                     used if it was received at most the given number of milliseconds ago.
+     *                   - lazyConnect: If "1", channels are only created when the first accessor of the register is
+     *                     requested. Else all channels of the map file are connected in the constructor.
+     *                   - metadataCache: File used to cache the meta data of the channels. Registers found in the
+     *                     cache are added to the catalogue without waiting for their channels.
+     *                   - partialOpenTimeout: Enables opening the backend if not all channels are connected. It is the
+     *                     time in milliseconds to wait for the channels before opening with the connected subset.
+     *                   - caContexts: Number of channel access contexts the channels are distributed to (default 1).
+     *                     Each context has its own connections and callback threads.
+     *                   - queueLength: Default length of the notification queues (default 3, 1000 in lossless mode).
+     *                   - lossless: If "1", events in the notification queues are never overwritten by default.
+     *                   - sharedDecoding: If "1", monitor events are converted once per user type and shared by all
+     *                     accessors of the same pv (see ChannelInfo::_decoded).
+     */
+    EpicsBackend(const std::string& mapfile = "", std::map<std::string, std::string> parameters = {});
+
+    /**
+     * Tracker used for all asynchronous writes of the backend. Failed writes are reported by the next transfer of an
+     * accessor of the same pv. It is replaced when opening the backend, since puts pending when closing are never
+     * completed.
+     */
+    std::shared_ptr<EpicsPutTracker> _asyncWrites{std::make_shared<EpicsPutTracker>()};
+
+    size_t _maxPendingWrites{100}; ///< Maximum number of asynchronous writes in flight
+
+    ChannelManager _channelManager; ///< Channels of this backend
+
+    /**
+     * Attach the calling thread to a channel access context of the backend. Each backend has its own contexts, so
+     * this is needed before calling channel access functions that use the context of the calling thread (e.g.
+     * ca_pend_io, ca_flush_io or ca_create_channel). Does nothing if the thread is attached already.
+     * \param shard Index of the context, see ChannelInfo::_shard.
+     * \throw ChimeraTK::runtime_error if attaching fails.
+     */
+    void attachContext(size_t shard = 0);
+
+    /**
+     * Get the index of the context used for a channel. Channels are distributed by the hash of their name.
+     */
+    size_t getShard(const std::string& caName) const;
+
+    /**
+     * Flush the send buffers of all contexts of the backend.
+     */
+    void flushIO();
+
+    /**
+     * Check if the channel access contexts were destroyed by close(). Channel access functions using the context of
+     * the calling thread must not be called then.
+     */
+    bool isContextDestroyed() const { return _contextDestroyed; }
+
+    /**
+     * Open the backend also if not all channels are connected. Channels connecting later are activated for async read
+     * by the channelStateHandler. Transfers of registers with unconnected channels throw ChimeraTK::runtime_error.
+     */
+    bool _partialOpen{false};
+    double _partialOpenTimeout{0}; ///< Time in seconds to wait for all channels in partial open mode
+
+    bool _sharedDecoding{false}; ///< Convert each monitor event once for all accessors of the same user type
+
+    bool _cachedReads{false};                       ///< Serve synchronous reads from the last monitored value
+    std::chrono::milliseconds _cachedReadMaxAge{0}; ///< Maximum age of the monitored value used for synchronous reads
 
     /**
      * Return the catalog and if not filled yet fill it.
      */
-    RegisterCatalogue getRegisterCatalogue() const override { return RegisterCatalogue(_catalogue_mutable.clone()); };
+    RegisterCatalogue getRegisterCatalogue() const override {
+      // registers are modified when they are connected in lazy connect mode
+      std::lock_guard<std::mutex> lock(_connectLock);
+      return RegisterCatalogue(_catalogue_mutable.clone());
+    };
 
     void setExceptionImpl() noexcept override;
 
@@ -93,14 +174,90 @@ namespace ChimeraTK {
 
     void fillCatalogueFromMapFile(const std::string& mapfile);
 
-    void addCatalogueEntry(RegisterPath path, std::shared_ptr<std::string> pvName);
+    EpicsWriteMode _writeMode{EpicsWriteMode::sync}; ///< Default used for registers without writeMode in the map file
+    size_t _queueLength{0}; ///< Default length of the notification queues, 0 to use the default of the mode
+    bool _lossless{false};  ///< Default of the lossless option used for registers without lossless in the map file
+
+    static constexpr size_t defaultQueueLength{3};            ///< Length of the notification queues
+    static constexpr size_t defaultLosslessQueueLength{1000}; ///< Length of the notification queues in lossless mode
+
+    bool _lazyConnect{false};        ///< Only create channels for registers that are used
+    mutable std::mutex _connectLock; ///< Lock used to protect the catalogue and connecting registers
+
+    /** Cache of the channel meta data. Only used if the CDD parameter metadataCache is set. */
+    std::unique_ptr<EpicsMetadataCache> _metadataCache;
+
+    /**
+     * Add register to the catalogue and create its channel (except in lazy connect mode).
+     * \param info Register info with path, pv name and the options from the map file.
+     */
+    void addCatalogueEntry(EpicsBackendRegisterInfo info);
 
     void configureChannel(EpicsBackendRegisterInfo& info);
 
+    /**
+     * Fill type, number of elements, access rights and data descriptor of the register.
+     */
+    static void fillRegisterInfo(EpicsBackendRegisterInfo& info, const EpicsChannelMetadata& metadata);
+
+    /**
+     * Create the channel. It is configured from the metadata cache if the pv is found in the cache.
+     * \throw ChimeraTK::runtime_error if the channel can not be created.
+     */
+    void createChannel(const std::string& caName);
+
+    /**
+     * Update the configured registers from the meta data of their channels. The type, length or access rights might
+     * differ from the metadata cache or the server might have changed them while the backend was closed.
+     */
+    void updateCatalogue();
+
+    /**
+     * Store the meta data of all channels that were connected in the metadata cache and write the cache file.
+     */
+    void updateMetadataCache();
+
+    /**
+     * Create the channel of the register if not done yet and fill the meta data of the register from the channel. Used
+     * in lazy connect mode, where the catalogue is only filled with the names of the registers in the constructor.
+     * \throw ChimeraTK::runtime_error if the channel does not connect within default_ca_timeout.
+     * \throw ChimeraTK::logic_error if a new channel is needed while the device is closed.
+     */
+    void connectRegister(EpicsBackendRegisterInfo& info);
+
+    /**
+     * Convert the write mode given in the CDD or the map file.
+     * \throw ChimeraTK::logic_error if the mode is unknown.
+     */
+    static EpicsWriteMode parseWriteMode(const std::string& mode);
+
+    /**
+     * Parse the length of the notification queues.
+     * \throw ChimeraTK::logic_error if the value is not a number larger than 0.
+     */
+    static size_t parseQueueLength(const std::string& value);
+
+    /**
+     * Convert a non-negative number given in the CDD.
+     * \throw ChimeraTK::logic_error if the value is not a number.
+     */
+    static size_t parseNumber(const std::string& name, const std::string& value);
+
     /**
      * Prepare channel access context.
      */
     void prepareChannelAccess();
+
+    size_t _nContexts{1};                        ///< Number of channel access contexts
+    std::vector<ca_client_context*> _caContexts; ///< Channel access contexts of the backend
+    bool _contextDestroyed{false};               ///< The channel access contexts were destroyed by close()
+
+    /**
+     * Wait until all channels are connected. In partial open mode only _partialOpenTimeout is waited and missing
+     * channels are reported to std::cerr.
+     * \throw ChimeraTK::runtime_error if no channel is connected (except in partial open mode).
+     */
+    void waitForChannels();
   };
 
 } // namespace ChimeraTK
@@ -10,6 +10,10 @@
 
 #include "EPICS-Backend.h"
 #include "EPICSChannelManager.h"
+#include "EPICSConversion.h"
+#include "EPICSGetTracker.h"
+#include "EPICSPutTracker.h"
+#include "EPICSTransferBatch.h"
 #include "EPICSTypes.h"
 #include "EPICSVersionMapper.h"
 
@@ -21,8 +25,14 @@
 
 #include <cadef.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring> // memcpy
+#include <iostream>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <vector>
 namespace ChimeraTK {
 
   template<typename DestType, typename SourceType>
@@ -138,7 +148,8 @@ namespace ChimeraTK {
    public:
     EpicsBackendRegisterAccessorBase(boost::shared_ptr<EpicsBackend> backend, const EpicsBackendRegisterInfo& info,
         size_t numberOfWords, size_t wordOffsetInRegister)
-    : _info(info), _backend(backend), _numberOfWords(numberOfWords), _offsetWords(wordOffsetInRegister) {}
+    : _info(info), _backend(backend), _numberOfWords(numberOfWords), _offsetWords(wordOffsetInRegister),
+      _queueLength(info._queueLength), _lossless(info._lossless) {}
     EpicsBackendRegisterInfo _info;
     cppext::future_queue<EpicsRawData> _notifications;
     boost::shared_ptr<EpicsBackend> _backend;
@@ -147,11 +158,125 @@ namespace ChimeraTK {
     bool _isPartial{false};
     ChimeraTK::VersionNumber _currentVersion;
     bool _hasNotificationsQueue{false};
+    size_t _queueLength{3};         ///< Length of the notification queue.
+    bool _lossless{false};          ///< Do not overwrite events in the notification queue
+    ChannelInfo* _channel{nullptr}; ///< Channel of the accessor. Kept to avoid map lookups in each transfer.
+    size_t _layoutVersion{0};       ///< ChannelInfo::_layoutVersion when the accessor was created
+    EpicsRawData _data;             ///< Payload received by the last read. It is converted in doPostRead.
+
+    /** Number of monitor events lost because the notification queue was full. */
+    std::atomic<size_t> _nOverflows{0};
+
+    /** Events were dropped in lossless mode and the next pushed event has not been marked yet (ChannelInfo::_lock) */
+    bool _eventsDropped{false};
+
+    /** Events were dropped in lossless mode before the event of the last read (see isAfterLoss). */
+    bool _afterLoss{false};
+
+    /**
+     * Get the number of monitor events lost because the notification queue was full. In the default mode the last
+     * event in the queue was overwritten, in lossless mode the new event was dropped (see isAfterLoss).
+     */
+    size_t getNumberOfOverflows() const { return _nOverflows; }
+
+    /**
+     * Check if events were dropped in lossless mode directly before the event received by the last read. The value of
+     * the event itself is valid, so the DataValidity is not changed.
+     */
+    bool isAfterLoss() const { return _afterLoss; }
+
+    /**
+     * Check that the type and length of the pv did not change since the accessor was created.
+     * \throw ChimeraTK::runtime_error if the accessor is invalid, since its buffers do not fit the pv anymore.
+     */
+    void checkLayout();
+
+    /**
+     * Push an exception to the notification queue if the accessor is invalid (see checkLayout).
+     * \return True if the exception was pushed, i.e. the event must not be pushed.
+     */
+    bool pushLayoutError();
+
+    /**
+     * Push a monitor event to the notification queue. If the queue is full, the last event in the queue is overwritten
+     * and the overflow is counted. In lossless mode the new event is dropped instead and the next event pushed is
+     * marked, so the consumer can detect the loss with isAfterLoss().
+     */
+    void pushEvent(const EpicsRawData& data);
+
+    /** Buffer for synchronous reads. The buffer memory is allocated with the first read. */
+    std::unique_ptr<EpicsBufferPool> _readBuffers;
+
+    /** Buffer of a read request that is not completed yet (see requestRead). */
+    std::shared_ptr<void> _pendingRead;
+
+    /** Low level element used in TransferGroups. Only used if the accessor has no notification queue. */
+    boost::shared_ptr<EpicsTransferBatch> _batch;
+
     /**
      * Push value to the notification queue. Used if subscription already exists and an additional accessor is added to
      * the ChannelManager.
      */
-    virtual void setInitialValue(void* value, long type, long count) = 0;
+    virtual void setInitialValue(const EpicsRawData& data) = 0;
+
+    /**
+     * Read the channel from the server into _data.
+     */
+    void readValue();
+
+    /**
+     * Send the read request for the channel without waiting for the answer. The value is available in _data after
+     * the tracker completed all requests successfully and finishRead was called. Used to read multiple channels with
+     * one round trip.
+     */
+    void requestRead(EpicsGetTracker& tracker);
+
+    /**
+     * Take the last monitored value as read value, if cached reads are enabled for the backend. The value is only used
+     * if the channel has an active subscription, is connected and the value is not older than the configured age.
+     *
+     * \return False if the value has to be read from the server.
+     */
+    bool readCachedValue();
+
+    /**
+     * Make the value requested by requestRead available in _data.
+     * \remark Only to be called after the get of the tracker completed successfully.
+     */
+    void finishRead();
+
+    /**
+     * Write the user buffer to the server. In write mode confirmed it waits for the completion. This is the
+     * synchronous write transfer without the check for active exceptions.
+     *
+     * \throw ChimeraTK::runtime_error if the put failed or did not complete in time.
+     */
+    void writeValue();
+
+    /**
+     * Send the put request for the user buffer without waiting for its completion. Used to write multiple channels
+     * with one round trip. The status of the put is reported by the tracker.
+     */
+    virtual void requestWrite(EpicsPutTracker& tracker) = 0;
+
+    /**
+     * Send the put request for the user buffer using the tracker for asynchronous writes of the backend. Waits if the
+     * maximum number of writes in flight is reached.
+     */
+    void requestAsyncWrite();
+
+    /**
+     * Get the current value of the whole array, which is needed to write only a part of it.
+     * The last monitored value is used if the channel has an active subscription. Else the value is read from the
+     * server, which needs an additional round trip.
+     */
+    EpicsRawData getValueForPartialWrite();
+
+    /**
+     * Throw the error of a failed asynchronous write of the pv.
+     * \throw ChimeraTK::runtime_error if an asynchronous write failed since the last check.
+     */
+    void checkAsyncWriteError();
   };
 
   template<typename EpicsBaseType, typename EpicsType, typename CTKType>
@@ -161,23 +286,31 @@ namespace ChimeraTK {
 
     void doReadTransferSynchronously() override;
 
-    void doPreRead(TransferType) override {
+    void doPreRead(TransferType type) override {
       if(!_backend->isOpen()) throw ChimeraTK::logic_error("Read operation not allowed while device is closed.");
+      if(_batch) _batch->preRead(type);
     }
 
-    void doPreWrite(TransferType, VersionNumber) override {
+    void doPreWrite(TransferType type, VersionNumber versionNumber) override {
       if(!_backend->isOpen()) throw ChimeraTK::logic_error("Write operation not allowed while device is closed.");
+      if(_batch) _batch->preWrite(type, versionNumber);
     }
 
     bool doWriteTransfer(VersionNumber /*versionNumber*/ = {}) override;
 
-    void doPostRead(TransferType, bool hasNewData) override;
+    void requestWrite(EpicsPutTracker& tracker) override;
+
+    void doPostRead(TransferType type, bool hasNewData) override;
+
+    void doPostWrite(TransferType type, VersionNumber versionNumber) override {
+      if(_batch) _batch->postWrite(type, versionNumber);
+    }
 
     /**
      * Push value to the notification queue. Used if subscription already exists and an additional accessor is added to
      * the ChannelManager.
      */
-    void setInitialValue(void* value, long type, long count) override;
+    void setInitialValue(const EpicsRawData& data) override;
 
     bool isReadOnly() const override { return (_info._isReadable && !_info._isWritable); }
 
@@ -190,18 +323,41 @@ namespace ChimeraTK {
     using TransferElement::_readQueue;
 
     std::vector<boost::shared_ptr<TransferElement>> getHardwareAccessingElements() override {
+      if(_batch) return {_batch};
       return {boost::enable_shared_from_this<TransferElement>::shared_from_this()};
     }
 
-    std::list<boost::shared_ptr<TransferElement>> getInternalElements() override { return {}; }
+    std::list<boost::shared_ptr<TransferElement>> getInternalElements() override {
+      if(_batch) return {_batch};
+      return {};
+    }
 
-    void replaceTransferElement(boost::shared_ptr<TransferElement> /*newElement*/) override {} // LCOV_EXCL_LINE
+    /**
+     * Merge the batch of this accessor with the batch given or used by the given accessor, so all of them are
+     * transferred together.
+     */
+    void replaceTransferElement(boost::shared_ptr<TransferElement> newElement) override;
 
     friend class EpicsBackend;
 
     EpicsRangeCheckingDataConverter<CTKType, EpicsBaseType> toCTK;
     EpicsRangeCheckingDataConverter<EpicsBaseType, CTKType> toEpics;
 
+    /** Take converted monitor events from ChannelInfo::_decoded. Not used if no conversion is needed. */
+    bool _sharedDecoding{false};
+
+    /**
+     * Convert _numberOfWords elements of the pv value into the given buffer.
+     * \param source Pointer to the first element of the whole pv value.
+     */
+    void convertValue(CTKType* dest, const EpicsBaseType* source);
+
+    /**
+     * Fill the user buffer with the monitor event in _data converted by the first accessor of the channel with the
+     * same user type, offset and length. The event is converted if no such accessor converted it yet.
+     */
+    void readSharedValue(const EpicsBaseType* source);
+
     EpicsBackendRegisterAccessor(const RegisterPath& path, boost::shared_ptr<DeviceBackend> backend,
         const EpicsBackendRegisterInfo& registerInfo, AccessModeFlags flags, size_t numberOfWords,
         size_t wordOffsetInRegister, bool asyncReadActivated);
@@ -222,70 +378,78 @@ namespace ChimeraTK {
     if(flags.has(AccessMode::raw)) throw ChimeraTK::logic_error("Raw access mode is not supported.");
     NDRegisterAccessor<CTKType>::buffer_2D.resize(1);
     this->accessChannel(0).resize(numberOfWords);
-    std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-    auto pv = ChannelManager::getInstance().getPV(_info._caName);
+    _channel = _backend->_channelManager.getChannel(_info._caName);
+    _layoutVersion = _channel->_layoutVersion;
+    auto pv = _channel->_pv;
     if(flags.has(AccessMode::wait_for_new_data)) {
       _hasNotificationsQueue = true;
-      _notifications = cppext::future_queue<EpicsRawData>(3);
-      _readQueue = _notifications.then<void>(
-          [pv](EpicsRawData& data) { memcpy(pv->value, data.data, data.size); }, std::launch::deferred);
+      _notifications = cppext::future_queue<EpicsRawData>(_queueLength);
+      // keep a reference to the received payload - it is converted in doPostRead without copying it before
+      _readQueue =
+          _notifications.then<void>([this](EpicsRawData& data) { _data = std::move(data); }, std::launch::deferred);
+    }
+    else {
+      _batch = boost::make_shared<EpicsTransferBatch>(_backend);
+      _batch->add(this);
     }
     if(pv->nElems != numberOfWords) _isPartial = true;
-    ChannelManager::getInstance().addAccessor(_info._caName, this);
+    if constexpr(!std::is_same_v<EpicsBaseType, CTKType> && !std::is_array_v<EpicsBaseType>) {
+      _sharedDecoding = _backend->_sharedDecoding && _hasNotificationsQueue;
+    }
+    // one buffer is enough, since _data is released before each read
+    _readBuffers = std::make_unique<EpicsBufferPool>(dbr_size_n(pv->dbrType, pv->nElems), 1);
+    _backend->_channelManager.addAccessor(_info._caName, this);
     if(flags.has(AccessMode::wait_for_new_data) && asyncReadActivated) {
-      ChannelManager::getInstance().activateChannel(_info._caName);
+      _backend->_channelManager.activateChannel(_info._caName);
     }
     NDRegisterAccessor<CTKType>::_exceptionBackend = backend;
   }
 
   template<typename EpicsBaseType, typename EpicsType, typename CTKType>
-  void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::setInitialValue(
-      void* value, long type, long count) {
-    auto data = EpicsRawData(value, type, count);
-    _notifications.push_overwrite(std::move(data));
+  void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::setInitialValue(const EpicsRawData& data) {
+    if(pushLayoutError()) return;
+    _notifications.push_overwrite(EpicsRawData(data));
   }
 
   template<typename EpicsBaseType, typename EpicsType, typename CTKType>
   void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::doReadTransferSynchronously() {
     _backend->checkActiveException();
-    std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-    auto pv = ChannelManager::getInstance().getPV(_info._caName);
-    // one could also use ChannelManager::isChannelConnected -> however we ask explicitly ChannelAccess here
-    if(ca_state(pv->chid) == cs_conn) {
-      if(pv->nElems == 1) {
-        auto result = ca_get(pv->dbrType, pv->chid, pv->value);
-        if(result != ECA_NORMAL) {
-          throw ChimeraTK::runtime_error(std::string("Failed to read pv: ") + pv->name);
-        }
-        result = ca_pend_io(default_ca_timeout);
-        if(result == ECA_TIMEOUT) {
-          throw ChimeraTK::runtime_error(std::string("Read operation timed out for pv: ") + pv->name);
-        }
-      }
-      else {
-        auto result = ca_array_get(pv->dbrType, pv->nElems, pv->chid, pv->value);
-        if(result != ECA_NORMAL) {
-          throw ChimeraTK::runtime_error(std::string("Failed to read pv: ") + pv->name);
-        }
-        result = ca_pend_io(default_ca_timeout);
-        if(result == ECA_TIMEOUT) {
-          throw ChimeraTK::runtime_error(std::string("Read operation timed out for pv: ") + pv->name);
-        }
-      }
-    }
-    else {
-      throw ChimeraTK::runtime_error(
-          std::string("ChannelAccess not connected in doReadTransferSynchronously when writing: ") + _info._name + "(" +
-          pv->name + ")");
+    checkLayout();
+    _backend->attachContext(_channel->_shard);
+    checkAsyncWriteError();
+    if(readCachedValue()) return;
+    readValue();
+  }
+
+  template<typename EpicsBaseType, typename EpicsType, typename CTKType>
+  void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::replaceTransferElement(
+      boost::shared_ptr<TransferElement> newElement) {
+    if(!_batch) return;
+    auto batch = boost::dynamic_pointer_cast<EpicsTransferBatch>(newElement);
+    if(!batch) {
+      auto accessor = boost::dynamic_pointer_cast<EpicsBackendRegisterAccessorBase>(newElement);
+      if(accessor) batch = accessor->_batch;
     }
+    if(!batch || batch == _batch || !batch->isMergeable(_backend)) return;
+    // keep the old batch alive while it is merged, since merging replaces _batch
+    auto oldBatch = _batch;
+    batch->merge(*oldBatch);
   }
 
   template<typename EpicsBaseType, typename EpicsType, typename CTKType>
-  void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::doPostRead(TransferType, bool hasNewData) {
-    if(!hasNewData) return;
-    std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-    auto pv = ChannelManager::getInstance().getPV(_info._caName);
-    EpicsBaseType* tmp = (EpicsBaseType*)dbr_value_ptr(pv->value, pv->dbrType);
+  void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::doPostRead(
+      TransferType type, bool hasNewData) {
+    if(_batch) _batch->postRead(type, hasNewData);
+    if(!hasNewData || !_data.data) return;
+    // events not containing the elements of the accessor are not pushed (see pushEvent), so this is only a safeguard
+    // against reading past the end of the payload
+    if(_data.count < _offsetWords + _numberOfWords) {
+      throw ChimeraTK::logic_error("Payload of pv " + _info._caName + " does not contain the elements of register " +
+          _info.getRegisterPath() + ".");
+    }
+    _afterLoss = _data.afterLoss;
+    // convert directly from the received payload, which is not shared with other accessors or changed by them
+    auto tmp = (const EpicsBaseType*)dbr_value_ptr(_data.data.get(), _channel->_pv->dbrType);
 
     if constexpr(std::is_array_v<EpicsBaseType>) {
       // only single element as checked in the constructor
@@ -294,14 +458,16 @@ namespace ChimeraTK {
       this->accessData(0) = toCTK.convert(tmpStr);
     }
     else {
-      for(size_t i = 0; i < _numberOfWords; i++) {
-        EpicsBaseType value = tmp[_offsetWords + i];
-        // Fill the NDRegisterAccessor buffer
-        this->accessData(i) = toCTK.convert(value);
+      // payloads of synchronous reads are never shared
+      if(_sharedDecoding && _data.sequence != 0) {
+        readSharedValue(tmp);
+      }
+      else {
+        convertValue(this->accessChannel(0).data(), tmp);
       }
     }
 
-    EpicsType* tp = (EpicsType*)pv->value;
+    auto tp = (const EpicsType*)_data.data.get();
     _currentVersion = EPICS::VersionMapper::getInstance().getVersion(tp[0].stamp);
     if(_currentVersion < _backend->_startVersion) {
       _currentVersion = _backend->_startVersion;
@@ -309,47 +475,119 @@ namespace ChimeraTK {
     TransferElement::_versionNumber = _currentVersion;
   }
 
+  template<typename EpicsBaseType, typename EpicsType, typename CTKType>
+  void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::convertValue(
+      CTKType* dest, const EpicsBaseType* source) {
+    if constexpr(hasArrayConversion<CTKType, EpicsBaseType>) {
+      // a single memcpy if the types match
+      convertArray(dest, source + _offsetWords, _numberOfWords);
+    }
+    else if constexpr(!std::is_array_v<EpicsBaseType>) {
+      // strings are converted in doPostRead
+      for(size_t i = 0; i < _numberOfWords; i++) {
+        EpicsBaseType value = source[_offsetWords + i];
+        dest[i] = toCTK.convert(value);
+      }
+    }
+  }
+
+  template<typename EpicsBaseType, typename EpicsType, typename CTKType>
+  void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::readSharedValue(const EpicsBaseType* source) {
+    std::lock_guard<std::mutex> lock(_channel->_decodedLock);
+    auto& decoded = _channel->_decoded;
+    auto entry = std::find_if(decoded.begin(), decoded.end(), [&](const ChannelInfo::DecodedValue& e) {
+      return e.type == typeid(CTKType) && e.offset == _offsetWords && e.length == _numberOfWords;
+    });
+    if(entry == decoded.end()) {
+      decoded.push_back({typeid(CTKType), _offsetWords, _numberOfWords, 0,
+          std::make_shared<std::vector<CTKType>>(_numberOfWords)});
+      entry = std::prev(decoded.end());
+    }
+    auto& value = *std::static_pointer_cast<std::vector<CTKType>>(entry->value);
+    // accessors reading an older event replace the value, so the others convert again - the result is the same
+    if(entry->sequence != _data.sequence) {
+      convertValue(value.data(), source);
+      entry->sequence = _data.sequence;
+    }
+    std::copy(value.begin(), value.end(), this->accessChannel(0).begin());
+  }
+
   template<typename EpicsBaseType, typename EpicsType, typename CTKType>
   bool EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::doWriteTransfer(
       VersionNumber /*versionNumber*/) {
     _backend->checkActiveException();
-    auto pv = ChannelManager::getInstance().getPV(_info._caName);
+    checkLayout();
+    _backend->attachContext(_channel->_shard);
+    checkAsyncWriteError();
+    if(_info._writeMode == EpicsWriteMode::async) {
+      requestAsyncWrite();
+      ca_flush_io();
+    }
+    else {
+      writeValue();
+    }
+    return true;
+  }
+
+  template<typename EpicsBaseType, typename EpicsType, typename CTKType>
+  void EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::requestWrite(EpicsPutTracker& tracker) {
+    auto pv = _channel->_pv;
     // one could also use ChannelManager::isChannelConnected -> however we ask explicitly ChannelAccess here
     if(ca_state(pv->chid) == cs_conn) {
-      if(_isPartial) EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::doReadTransferSynchronously();
-      long result;
+      // not done under the value lock, since the channel lock is needed to get the last monitored value
+      EpicsRawData current;
+      if(_isPartial) current = getValueForPartialWrite();
+      std::lock_guard<std::mutex> lock(_channel->_valueLock);
+      if constexpr(std::is_same_v<EpicsBaseType, CTKType>) {
+        // the whole array is written without conversion: ca_array_put copies the value, so the buffer of the accessor
+        // is passed directly
+        if(!_isPartial && pv->nElems == _numberOfWords) {
+          tracker.put(pv->dbfType, pv->nElems, pv->chid, this->accessChannel(0).data(), _info._caName);
+          _channel->_putPending = true;
+          _channel->_putInWriteBuffer = false;
+          return;
+        }
+      }
+      auto writeBuffer = _channel->getWriteBuffer();
+      if(_isPartial) {
+        memcpy(writeBuffer, current.data.get(), std::min<size_t>(current.size, _channel->_writeBufferSize));
+      }
       if constexpr(std::is_array_v<EpicsBaseType>) {
         // only single element as checked in the constructor
-        result = ca_array_put(pv->dbfType, pv->nElems, pv->chid, toEpics.convert(this->accessData(0)).c_str());
+        tracker.put(pv->dbfType, pv->nElems, pv->chid, toEpics.convert(this->accessData(0)).c_str(), _info._caName);
+        _channel->_putInWriteBuffer = false;
       }
       else {
-        EpicsBaseType* tmp = (EpicsBaseType*)dbr_value_ptr(pv->value, pv->dbrType);
-        for(size_t i = 0; i < _numberOfWords; i++) {
-          tmp[_offsetWords + i] = toEpics.convert(this->accessData(i));
+        EpicsBaseType* tmp = (EpicsBaseType*)dbr_value_ptr(writeBuffer, pv->dbrType);
+        if constexpr(hasArrayConversion<EpicsBaseType, CTKType>) {
+          convertArray(tmp + _offsetWords, this->accessChannel(0).data(), _numberOfWords);
         }
-        result = ca_array_put(pv->dbfType, pv->nElems, pv->chid, tmp);
-      }
-
-      if(result != ECA_NORMAL) {
-        std::cerr << "Failed to to write pv: " << _info._caName << std::endl;
-        return false;
-      }
-      result = ca_pend_io(default_ca_timeout);
-      if(result == ECA_TIMEOUT) {
-        std::cerr << "Timeout while writing pv: " << _info._caName << std::endl;
-        return false;
+        else {
+          for(size_t i = 0; i < _numberOfWords; i++) {
+            tmp[_offsetWords + i] = toEpics.convert(this->accessData(i));
+          }
+        }
+        tracker.put(pv->dbfType, pv->nElems, pv->chid, tmp, _info._caName);
+        _channel->_putInWriteBuffer = true;
       }
+      _channel->_putPending = true;
     }
     else {
       throw ChimeraTK::runtime_error(std::string("ChannelAccess not connected in doWriteTransfer when writing: ") +
           _info._name + "(" + pv->name + ")");
     }
-    return true;
   }
 
   template<typename EpicsBaseType, typename EpicsType, typename CTKType>
   EpicsBackendRegisterAccessor<EpicsBaseType, EpicsType, CTKType>::~EpicsBackendRegisterAccessor() {
-    ChannelManager::getInstance().removeAccessor(_info._caName, this);
+    try {
+      _backend->attachContext(_channel->_shard);
+    }
+    catch(ChimeraTK::runtime_error& e) {
+      std::cerr << e.what() << std::endl;
+    }
+    _backend->_channelManager.removeAccessor(_info._caName, this);
+    if(_batch) _batch->remove(this);
   }
 
 } // namespace ChimeraTK
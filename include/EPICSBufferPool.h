@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+/*
+ * EPICSBufferPool.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ChimeraTK {
+
+  /**
+   * Pool of equally sized buffers used for the payload of the monitor events of one channel.
+   *
+   * Buffers are handed out as shared pointers. A buffer is reused as soon as the pool holds the only reference to it.
+   * Since the shared pointers themselves are kept in the pool, neither the buffer nor the control block is allocated
+   * again once the pool is filled. Use getNumberOfAllocations() and getNumberOfRequests() to check that no allocations
+   * happen in the steady state.
+   */
+  class EpicsBufferPool {
+   public:
+    /**
+     * Constructor.
+     *
+     * \param bufferSize Size of each buffer in bytes.
+     * \param capacity Maximum number of buffers kept in the pool. If all buffers are in use, an additional buffer is
+     *                 allocated. It is only kept in the pool if the capacity is not reached yet.
+     */
+    EpicsBufferPool(size_t bufferSize, size_t capacity);
+
+    /**
+     * Get a buffer that is not used by anyone else.
+     */
+    std::shared_ptr<void> get();
+
+    /**
+     * Change the maximum number of buffers kept in the pool. Surplus buffers are released if they are not in use.
+     */
+    void setCapacity(size_t capacity);
+
+    size_t getBufferSize() const { return _bufferSize; }
+
+    size_t getCapacity() const { return _capacity; }
+
+    /**
+     * Memory of the buffers kept in the pool in bytes.
+     */
+    size_t getMemory();
+
+    /**
+     * Number of buffers allocated since the pool was created.
+     */
+    size_t getNumberOfAllocations() const { return _nAllocations; }
+
+    /**
+     * Number of buffers requested since the pool was created.
+     */
+    size_t getNumberOfRequests() const { return _nRequests; }
+
+   private:
+    std::mutex _lock; ///< Lock used to protect the _buffers
+    std::vector<std::shared_ptr<void>> _buffers;
+    const size_t _bufferSize;
+    std::atomic<size_t> _capacity;
+    size_t _next{0}; ///< Index of the buffer to be checked first in the next call of get()
+    std::atomic<size_t> _nAllocations{0};
+    std::atomic<size_t> _nRequests{0};
+  };
+} // namespace ChimeraTK
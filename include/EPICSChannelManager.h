@@ -8,18 +8,25 @@
  *      Author: Klaus Zenker (HZDR)
  */
 
+#include "EPICSBufferPool.h"
+#include "EPICSMetadataCache.h"
 #include "EPICSTypes.h"
 
 #include <ChimeraTK/Exception.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring> // memcpy
 #include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <typeindex>
 #include <utility>
+#include <vector>
 
 namespace ChimeraTK {
   class EpicsBackendRegisterAccessorBase;
@@ -28,38 +35,113 @@ namespace ChimeraTK {
 
   /**
    * Struct used in the future queue to transfer data received from EPICS to the accesors.
+   * The payload is immutable and reference counted, so one event is copied only once and then shared by all
+   * accessors of the channel.
    */
   struct EpicsRawData {
-    void* data;
-    unsigned size;
-    EpicsRawData(const evargs& args) : size(dbr_size_n(args.type, args.count)) {
-      data = ::operator new(size);
-      memcpy(data, args.dbr, size);
+    std::shared_ptr<const void> data;
+    unsigned size{0};
+    /**
+     * Number of elements in the payload. Subscriptions might request only the first elements of the array, see
+     * ChannelManager::getSubscriptionElements.
+     */
+    unsigned count{0};
+    size_t sequence{0}; ///< Number of the monitor event in its channel (ChannelInfo::_nEvents). 0 for other payloads.
+    /** Previous events were dropped since the notification queue was full (lossless mode). */
+    bool afterLoss{false};
+    EpicsRawData() = default;
+    explicit EpicsRawData(const evargs& args) : EpicsRawData(args.dbr, args.type, args.count) {}
+    EpicsRawData(const void* dataPtr, long type, long nElements)
+    : size(dbr_size_n(type, nElements)), count(nElements) {
+      void* buffer = ::operator new(size);
+      memcpy(buffer, dataPtr, size);
+      data.reset(buffer, [](void* p) { ::operator delete(p); });
     }
-    EpicsRawData() : data(nullptr), size(0) {};
-    EpicsRawData(EpicsRawData&& other) : data(std::exchange(other.data, nullptr)), size(other.size) {};
-    EpicsRawData(const void* dataPtr, long type, long count) {
-      size = dbr_size_n(type, count);
-      data = ::operator new(size);
-      memcpy(data, dataPtr, size);
+    /**
+     * Copy the event payload into a buffer taken from the pool. The buffer size of the pool has to match the payload.
+     */
+    EpicsRawData(const evargs& args, EpicsBufferPool& pool)
+    : size(dbr_size_n(args.type, args.count)), count(args.count) {
+      auto buffer = pool.get();
+      memcpy(buffer.get(), args.dbr, size);
+      data = std::move(buffer);
     }
-    ~EpicsRawData() { ::operator delete(data); }
   };
 
   /**
    * Struct used to store all information and data for each channel access connection.
    * Also holds the pointers to all accessors linked to that channel.
+   *
+   * The state flags are atomic, so they can be checked without locking. The accessor list, the subscription and the
+   * last event are protected by _lock, the value buffer of the pv used to prepare writes is protected by _valueLock.
+   * Never acquire _lock while holding _valueLock.
    */
   struct ChannelInfo {
+    std::mutex _lock;      ///< Lock used to protect the accessor list and the subscription
+    std::mutex _valueLock; ///< Lock used to protect the write buffer _pv->value
     std::deque<EpicsBackendRegisterAccessorBase*> _accessors;
-    bool _configured{false};
-    bool _connected{false};
-    evid* _subscriptionId{nullptr}; ///< Id used for subscriptions
-    bool _asyncReadActivated{false};
-    bool _initialValueReceived{false};
+    EpicsBackend* _backend{nullptr}; ///< Backend that created the channel. Used to check/change its state in callbacks.
+    /** Manager holding the channel. Used in the callbacks. */
+    ChannelManager* _manager{nullptr};
+    size_t _shard{0}; ///< Index of the channel access context of the backend used for the channel
+    std::atomic<bool> _configured{false};
+    std::atomic<bool> _connected{false};
+    evid* _subscriptionId{nullptr}; ///< Id used for subscriptions. Also set while the subscription is suspended.
+    size_t _subscribedElements{0};  ///< Number of elements requested by the subscription (_lock)
+    size_t _subscribedLayout{0};    ///< _layoutVersion when the subscription was created (_lock)
+    std::atomic<bool> _asyncReadActivated{false}; ///< Events are sent to the accessors
+    std::atomic<bool> _initialValueReceived{false};
+    std::shared_ptr<EpicsBufferPool> _pool; ///< Buffers for the monitor payloads. Created when the first event arrives.
+
+    size_t _nEvents{0}; ///< Number of monitor events received. Used as EpicsRawData::sequence (_lock)
+
+    /** Value of a monitor event converted to a user type, see _decoded. */
+    struct DecodedValue {
+      std::type_index type;
+      size_t offset;
+      size_t length;
+      size_t sequence{0};          ///< EpicsRawData::sequence of the converted event
+      std::shared_ptr<void> value; ///< std::vector of the user type
+    };
+
+    /**
+     * Last monitor event converted by accessors with the given user type, offset and length. Only used with the CDD
+     * parameter sharedDecoding. Protected by _decodedLock.
+     */
+    std::vector<DecodedValue> _decoded;
+    std::mutex _decodedLock; ///< Lock used to protect _decoded
+
+    /** Payload of the last monitor event. Used as initial value for accessors added later. */
+    EpicsRawData _lastEvent;
+    std::chrono::steady_clock::time_point _lastEventTime; ///< Time when _lastEvent was received
+
     //\ToDo: Use pointer to have name persistent
     std::shared_ptr<pv> _pv;
     std::string _caName;
+    std::atomic<size_t> _writeBufferSize{0}; ///< Size of _pv->value in bytes. It is 0 until the first write.
+
+    /**
+     * A put was sent, but no monitor event with its value was received yet. _lastEvent might be older than the value
+     * on the server then, so it is not used for partial writes. Protected by _valueLock.
+     */
+    bool _putPending{false};
+    bool _putInWriteBuffer{false}; ///< The value of the pending put is still in the write buffer (_valueLock)
+
+    /**
+     * Meta data used to configure _pv. Number of elements and type are set once (from the server or the metadata
+     * cache), since the buffers of the accessors depend on them. The access rights are updated on each connect.
+     * Protected by _valueLock.
+     */
+    EpicsChannelMetadata _metadata;
+    EpicsChannelMetadata _serverMetadata; ///< Meta data reported by the server on the last connect (_valueLock)
+    std::atomic<bool> _validated{false};  ///< Channel was connected, i.e. _serverMetadata is filled
+
+    /**
+     * Increased if the type or the number of elements reported by the server differ from _metadata on connect, e.g.
+     * because the metadata cache is outdated. _metadata is updated then, and accessors created before are invalid,
+     * since their buffers depend on the layout.
+     */
+    std::atomic<size_t> _layoutVersion{0};
 
     /**
      * Constructor.
@@ -67,16 +149,47 @@ namespace ChimeraTK {
      * \param channelName
      * \throw ChimeraTK::runtime_error in case the channel access connection could not be set up.
      */
-    ChannelInfo(std::string channelName);
+    explicit ChannelInfo(std::string channelName);
+
+    /**
+     * Get the buffer used to prepare writes. It is allocated with the first call, so channels that are never written
+     * do not need memory for it.
+     *
+     * \remark _valueLock should be held by the calling function!
+     */
+    void* getWriteBuffer();
+
+    /**
+     * Set number of elements and type of _pv and mark the channel configured. The write buffer is released, since its
+     * size depends on the meta data.
+     *
+     * \remark _valueLock should be held by the calling function!
+     */
+    void configure(const EpicsChannelMetadata& metadata);
+
+    /**
+     * Clear _putPending if the value of the monitor event is the value of the pending put. Puts not sent from the
+     * write buffer stay pending, until a later put is confirmed this way.
+     *
+     * \remark _valueLock should be held by the calling function!
+     */
+    void checkPutReceived(const EpicsRawData& data);
+
+    ChannelInfo(const ChannelInfo&) = delete;
+    ChannelInfo& operator=(const ChannelInfo&) = delete;
 
     bool isChannelName(std::string channelName);
 
     bool operator==(const ChannelInfo& other);
   };
 
+  /**
+   * Registry of the channels of one backend. Each EpicsBackend has its own ChannelManager and channel access context,
+   * so several backends can be used independently in one process.
+   */
   class ChannelManager {
    public:
-    static ChannelManager& getInstance();
+    ChannelManager() = default;
 
     /**
      * Destructor called on SIGINT!
@@ -84,14 +197,19 @@ namespace ChimeraTK {
      */
     ~ChannelManager();
 
+    ChannelManager(const ChannelManager&) = delete;
+    ChannelManager& operator=(const ChannelManager&) = delete;
+
     /**
      * Handler called once the Channel Accesss is closed or opened.
      * It is to be registered with the Channel Access creation.
+     * The ChannelInfo of the channel is passed as user pointer of the channel, so no map lookup is needed here.
      */
     static void channelStateHandler(connection_handler_args args);
 
     /**
      * Handler called once data is updated on a EPICS channel.
+     * The ChannelInfo of the channel is passed as user pointer of the subscription, so no map lookup is needed here.
      */
     static void handleEvent(evargs args);
 
@@ -100,7 +218,6 @@ namespace ChimeraTK {
      *  \param name The EPICS channel access name.
      *  \param backend The backend pointer to be passed to the CA channel.
      *                 It is used to change the backend state and check if it is still open.
-     * \remark map should be locked by calling function!
      */
     void addChannel(const std::string name, EpicsBackend* backend);
 
@@ -109,10 +226,7 @@ namespace ChimeraTK {
      *
      *  \param backend The backend pointer to be passed to the CA channel.
      *                 It is used to change the backend state and check if it is still open.
-     *
-     * \remark map should be locked by calling function!
      */
-
     void addChannelsFromMap(EpicsBackend* backend);
 
     /**
@@ -123,6 +237,33 @@ namespace ChimeraTK {
      */
     bool checkAllConnections(const bool& connected);
 
+    /**
+     * Wait until all channels in the map are connected.
+     * The number of connected channels is updated by the channelStateHandler, so the function returns as soon as the
+     * last channel is connected.
+     *
+     * \param timeout Timeout in seconds.
+     * \return True if all channels are connected.
+     */
+    bool waitForAllConnections(double timeout);
+
+    /**
+     * Wait until the channel is connected.
+     *
+     * \param name The EPICS channel access name.
+     * \param timeout Timeout in seconds.
+     * \return True if the channel is connected.
+     */
+    bool waitForConnection(const std::string& name, double timeout);
+
+    /**
+     * Check if a channel is registered.
+     *
+     * \param name The EPICS channel access name.
+     * \return True if the channel was added before.
+     */
+    bool hasChannel(const std::string& name);
+
     /**
      * Check if channel is connected.
      *
@@ -144,10 +285,24 @@ namespace ChimeraTK {
      */
     void setException(const std::string error);
 
+    /**
+     * Get the memory used for value buffers of a channel. This includes the write buffer, the pool for monitor
+     * payloads and the buffers used by synchronous reads of its accessors.
+     *
+     * \param name The EPICS channel access name.
+     * \return Memory in bytes.
+     */
+    size_t getBufferMemory(const std::string& name);
+
+    /**
+     * Get the memory used for value buffers of all channels in bytes.
+     */
+    size_t getTotalBufferMemory();
+
     /**
      * Reset the map content
      */
-    void cleanup() { channelMap.clear(); };
+    void cleanup();
 
     /**
      * Check if channel access meta data is filled.
@@ -159,30 +314,64 @@ namespace ChimeraTK {
      */
     bool isChannelConfigured(const std::string& name);
 
+    /**
+     * Configure the channel from cached meta data, so accessors can be created before the channel is connected.
+     * Does nothing if the channel is configured already.
+     *
+     * \param name The EPICS channel access name.
+     * \param metadata The cached meta data.
+     */
+    void configureChannel(const std::string& name, const EpicsChannelMetadata& metadata);
+
+    /**
+     * Get the meta data used by the channel.
+     *
+     * \param name The EPICS channel access name.
+     * \param metadata Is filled with the meta data.
+     * \return False if the channel is not configured yet.
+     */
+    bool getMetadata(const std::string& name, EpicsChannelMetadata& metadata);
+
+    /**
+     * Get the meta data reported by the server on the last connect.
+     *
+     * \param name The EPICS channel access name.
+     * \param metadata Is filled with the meta data.
+     * \return False if the channel was never connected.
+     */
+    bool getServerMetadata(const std::string& name, EpicsChannelMetadata& metadata);
+
     /**
      * Get pv pointer.
      *
      * \param name The EPICS channel access name.
      * \return PV pointer
-     * \remark map should be locked by calling function!
      */
     std::shared_ptr<pv> getPV(const std::string& name);
 
     /**
-     * Create channel access subscription.
+     * Get the channel information.
+     * The returned pointer stays valid until the map is cleared (see cleanup()), so accessors can keep it and skip
+     * the map lookup when reading or writing.
      *
      * \param name The EPICS channel access name.
+     * \return Pointer to the ChannelInfo stored in the map.
+     */
+    ChannelInfo* getChannel(const std::string& name);
+
+    /**
+     * Create channel access subscription.
      *
-     * \remark map should be locked by calling function!
+     * \param name The EPICS channel access name.
      */
     void activateChannel(const std::string& name);
 
     /**
      * Activate all registered channels.
      *
-     * \remark map should be locked by calling function!
+     * \param connectedOnly If true, only connected channels are activated.
      */
-    void activateChannels();
+    void activateChannels(bool connectedOnly = false);
 
     /**
      * Wait until all channels received its initial value.
@@ -192,17 +381,34 @@ namespace ChimeraTK {
     bool checkInitialValueReceived();
 
     /**
-     * Deactivate subscription of all registered channels.
+     * Wait until all channels with async read received its initial value.
+     * The number of missing initial values is updated by handleEvent, so the function returns as soon as the last
+     * initial value is received.
      *
-     * \remark map should be locked by calling function!
+     * \param timeout Timeout in seconds.
+     * \return True if all channels with async read received an initial value.
+     */
+    bool waitForInitialValues(double timeout);
+
+    /**
+     * Deactivate subscription of all registered channels.
      */
     void deactivateChannels();
 
+    /**
+     * Suspend the subscription of all registered channels, i.e. stop sending events to the accessors. Activating the
+     * channels again sends the last event as initial value without contacting the server.
+     */
+    void suspendChannels();
+
+    /**
+     * Set the connected state of all channels to the state reported by channel access.
+     */
+    void updateConnectionState();
+
     /**
      * Reset configuration and connected state for all channels.
      * Remove all accessors.
-     *
-     * \remark map should be locked by calling function!
      */
     void resetConnectionState();
 
@@ -211,17 +417,42 @@ namespace ChimeraTK {
      *
      * \param name The EPICS channel access name.
      * \param accessor The accessor that is updated by changes from channel access
-     * \remark map should be locked by calling function!
      */
     void addAccessor(const std::string& name, EpicsBackendRegisterAccessorBase* accessor);
 
-    std::mutex mapLock; ///< Lock used to protect the channelMap
 #ifdef CHIMERATK_UNITTEST
-    std::atomic<long> currentState; // state used in the tests to wait for a connect/reconnect
+    static inline std::atomic<long> currentState{0}; // state used in the tests to wait for a connect/reconnect
 #endif
    private:
+    /**
+     * Lock used to protect the structure of the channelMap. Entries are only added while holding it exclusively, all
+     * other operations only need shared access. The CA callbacks do not need it at all.
+     */
+    std::shared_mutex mapLock;
     std::map<std::string, ChannelInfo> channelMap; ///< map that connects the EPICS PV name to the ChannelInfo object
 
+    /**
+     * Lock used to protect the counters below, which replace scanning the channelMap when waiting for connections and
+     * initial values. stateChanged is notified whenever a counter changes.
+     */
+    std::mutex stateLock;
+    std::condition_variable stateChanged;
+    size_t nChannels{0};             ///< Number of channels in the map
+    size_t nConnected{0};            ///< Number of connected channels
+    size_t nMissingInitialValues{0}; ///< Number of channels with async read waiting for the initial value
+
+    /**
+     * Set the connection state of the channel and update the number of connected channels.
+     * \return The previous connection state.
+     */
+    bool setConnected(ChannelInfo* channel, bool connected);
+
+    /**
+     * Update the number of channels waiting for the initial value.
+     * \param increase True to increase the number, false to decrease it.
+     */
+    void updateMissingInitialValues(bool increase);
+
     /**
      *  Check if a channel is registered.
      *  \param name The EPICS channel access name.
@@ -230,18 +461,73 @@ namespace ChimeraTK {
     bool channelPresent(const std::string name);
 
     /**
-     * Find the entry in the map for a given chanId.
-     * \param chid The chanId of the PV.
-     * \return Iterator to the internal map.
-     * \throw ChimeraTK::runtime_error if chid is not found.
-     * \remark Lock the map if you intend to change the map!
+     * Get pointers to all channels in the map.
+     * The map lock is only held while collecting the pointers, so the channels can be processed without holding it.
      */
-    std::map<std::string, ChannelInfo>::iterator findChid(const chanId& chid);
+    std::vector<ChannelInfo*> getChannels();
 
     /**
-     * Create channel access subscription.
+     * Create channel access subscription. If the subscription of the channel was only suspended (see suspendChannel),
+     * it is resumed without contacting the server: the last event is sent to the accessors as initial value. If the
+     * channel is not connected or has no last event, the next event of the subscription is the initial value.
      * @param channel
      */
     void activateChannel(ChannelInfo* channel);
+
+    /**
+     * Remove channel access subscription.
+     * @param channel
+     * \return False if the channel had no subscription.
+     * \remark channel must not be locked by calling function, since the subscription callback might be running.
+     */
+    bool deactivateChannel(ChannelInfo* channel);
+
+    /**
+     * Stop sending events of the channel to the accessors, but keep the subscription. Channel access reinstalls the
+     * subscription if the channel reconnects, so a disconnect or an exception only causes network traffic for the
+     * affected channels.
+     * @param channel
+     */
+    void suspendChannel(ChannelInfo* channel);
+
+    /**
+     * Flush the send buffer of the channel access context used by the channel.
+     * \param channel
+     */
+    static void flush(ChannelInfo* channel);
+
+    /**
+     * Get the payload buffer pool of the channel. A new pool is created if there is none yet or if the buffer size
+     * changed.
+     * \param channel
+     * \param bufferSize The size of the payload in bytes.
+     * \remark channel should be locked by calling function!
+     */
+    static EpicsBufferPool& getPool(ChannelInfo* channel, size_t bufferSize);
+
+    /**
+     * Number of elements to be requested by the subscription of the channel. Only the first elements up to the end of
+     * the accessor reaching furthest into the array are requested, so accessors of the beginning of large arrays do
+     * not transfer the whole array.
+     * \remark channel should be locked by calling function!
+     */
+    static size_t getSubscriptionElements(ChannelInfo* channel);
+
+    /**
+     * Number of payload buffers that can be in use at the same time by the accessors of the channel. The buffers of
+     * accessors in the default mode are limited to maxPoolCapacity, longer queues only allocate additional buffers
+     * while they are filled. The buffers of lossless accessors are not limited, so a lossless queue does not allocate
+     * while it is filled up to its length.
+     * \remark channel should be locked by calling function!
+     */
+    static size_t getPoolCapacity(ChannelInfo* channel);
+
+    /** Maximum number of buffers kept in the pool of a channel for the accessors in the default mode */
+    static constexpr size_t maxPoolCapacity{64};
+
+    /**
+     * Get the memory used for value buffers of the channel in bytes.
+     */
+    static size_t getBufferMemory(ChannelInfo* channel);
   };
 } // namespace ChimeraTK
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+/*
+ * EPICSConversion.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstring> // memcpy
+#include <limits>
+#include <type_traits>
+
+namespace ChimeraTK {
+
+  /**
+   * True if convertArray() can be used to convert between the two types, i.e. both are arithmetic types.
+   */
+  template<typename DestType, typename SourceType>
+  constexpr bool hasArrayConversion = std::is_arithmetic_v<DestType> && std::is_arithmetic_v<SourceType> &&
+      !std::is_same_v<DestType, bool> && !std::is_same_v<SourceType, bool>;
+
+  /**
+   * Convert an array of numbers. Values out of range are saturated and floating point values converted to integers are
+   * rounded to the nearest integer (halfway cases away from zero), like with the EpicsRangeCheckingDataConverter. The
+   * result differs from converting each element with the EpicsRangeCheckingDataConverter in two cases:
+   *  - Negative values below the range of a floating point type (e.g. -1e300 converted to float) give the lowest
+   *    value (-max). The converter returns std::numeric_limits<DestType>::min() there, which is the smallest positive
+   *    normalised value.
+   *  - NaN converted to an integer type gives 0. NaN passes the range check of the converter, so its result is
+   *    undefined.
+   *
+   * The loops contain no function calls or exceptions, so the compiler can vectorise them.
+   *
+   * \param dest The destination array with at least n elements.
+   * \param source The source array with at least n elements. It must not overlap with dest.
+   * \param n Number of elements to convert.
+   */
+  template<typename DestType, typename SourceType>
+  void convertArray(DestType* __restrict dest, const SourceType* __restrict source, size_t n) {
+    static_assert(hasArrayConversion<DestType, SourceType>);
+    using DestLimits = std::numeric_limits<DestType>;
+    using SourceLimits = std::numeric_limits<SourceType>;
+    if constexpr(std::is_same_v<DestType, SourceType>) {
+      memcpy(dest, source, n * sizeof(DestType));
+    }
+    else if constexpr(std::is_floating_point_v<DestType>) {
+      if constexpr(std::is_floating_point_v<SourceType> && sizeof(SourceType) > sizeof(DestType)) {
+        // narrowing, e.g. double to float - NaN is kept, since both comparisons are false
+        constexpr auto max = static_cast<SourceType>(DestLimits::max());
+        for(size_t i = 0; i < n; ++i) {
+          auto x = source[i];
+          dest[i] = static_cast<DestType>(x > max ? max : (x < -max ? -max : x));
+        }
+      }
+      else {
+        // every value is in range
+        for(size_t i = 0; i < n; ++i) {
+          dest[i] = static_cast<DestType>(source[i]);
+        }
+      }
+    }
+    else if constexpr(std::is_floating_point_v<SourceType>) {
+      // largest value with a fractional part - larger values are integers already
+      constexpr auto integral = static_cast<SourceType>(1ULL << (SourceLimits::digits - 1));
+      // adding the largest value below 0.5 and truncating rounds halfway cases away from zero, like std::round
+      constexpr auto half = static_cast<SourceType>(0.5) - SourceLimits::epsilon() / 4;
+      // hi might be rounded up to the next power of 2, so values equal to it are saturated as well
+      constexpr auto hi = static_cast<SourceType>(DestLimits::max());
+      constexpr auto lo = static_cast<SourceType>(DestLimits::min());
+      for(size_t i = 0; i < n; ++i) {
+        auto x = source[i];
+        auto y = std::fabs(x) < integral ? x + std::copysign(half, x) : x;
+        dest[i] = y >= hi ? DestLimits::max() : (y <= lo ? DestLimits::min() : (y == y ? static_cast<DestType>(y) : 0));
+      }
+    }
+    else if constexpr(std::is_signed_v<SourceType> && std::is_unsigned_v<DestType>) {
+      constexpr bool checkMax = static_cast<std::make_unsigned_t<SourceType>>(SourceLimits::max()) > DestLimits::max();
+      for(size_t i = 0; i < n; ++i) {
+        auto x = source[i];
+        if constexpr(checkMax) {
+          constexpr auto max = static_cast<SourceType>(DestLimits::max());
+          dest[i] = static_cast<DestType>(x < 0 ? 0 : (x > max ? max : x));
+        }
+        else {
+          dest[i] = x < 0 ? 0 : static_cast<DestType>(x);
+        }
+      }
+    }
+    else if constexpr(std::is_unsigned_v<SourceType> && std::is_signed_v<DestType>) {
+      constexpr bool checkMax = SourceLimits::max() > static_cast<std::make_unsigned_t<DestType>>(DestLimits::max());
+      for(size_t i = 0; i < n; ++i) {
+        auto x = source[i];
+        if constexpr(checkMax) {
+          dest[i] = x > static_cast<SourceType>(DestLimits::max()) ? DestLimits::max() : static_cast<DestType>(x);
+        }
+        else {
+          dest[i] = static_cast<DestType>(x);
+        }
+      }
+    }
+    else if constexpr(sizeof(SourceType) > sizeof(DestType)) {
+      // narrowing with the same signedness
+      constexpr auto max = static_cast<SourceType>(DestLimits::max());
+      constexpr auto min = static_cast<SourceType>(DestLimits::min());
+      for(size_t i = 0; i < n; ++i) {
+        auto x = source[i];
+        dest[i] = static_cast<DestType>(x > max ? max : (x < min ? min : x));
+      }
+    }
+    else {
+      // widening with the same signedness
+      for(size_t i = 0; i < n; ++i) {
+        dest[i] = static_cast<DestType>(source[i]);
+      }
+    }
+  }
+} // namespace ChimeraTK
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+/*
+ * EPICSGetTracker.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <cadef.h>
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ChimeraTK {
+
+  /**
+   * Tracks get requests sent with ca_array_get_callback until their values were received.
+   *
+   * Unlike ca_pend_io, which waits for all gets of the context of the calling thread, each tracker only waits for its
+   * own requests. So synchronous reads of different threads using the same context do not interfere. It is used to
+   * send the gets of multiple accessors before waiting for all of them once (see EpicsTransferBatch).
+   *
+   * Each pending request keeps the tracker and its buffer alive, so it is safe to give up waiting after a timeout.
+   */
+  class EpicsGetTracker : public std::enable_shared_from_this<EpicsGetTracker> {
+   public:
+    /**
+     * Send a get request. The send buffer is not flushed, call ca_flush_io after sending all requests.
+     *
+     * \param type The DBR type of the value.
+     * \param count Number of elements.
+     * \param chid The channel id.
+     * \param buffer Buffer the received payload is copied to. It has to hold count elements of the given type.
+     * \param name Name of the pv. It is used to report the status of the get.
+     * \return The status returned by ca_array_get_callback.
+     */
+    int get(long type, unsigned long count, chanId chid, std::shared_ptr<void> buffer, const std::string& name);
+
+    /**
+     * Wait until the values of all gets are received.
+     *
+     * \param timeout Timeout in seconds.
+     * \return False in case of a timeout.
+     */
+    bool wait(double timeout);
+
+    /**
+     * Check that all gets completed successfully.
+     *
+     * \throw ChimeraTK::runtime_error naming the failed and not yet completed gets.
+     */
+    void checkErrors();
+
+   private:
+    /**
+     * Handler called by channel access with the value of a get.
+     * The usr pointer is a Request allocated in get().
+     */
+    static void getHandler(evargs args);
+
+    struct Request {
+      std::shared_ptr<EpicsGetTracker> tracker;
+      size_t id;
+      std::shared_ptr<void> buffer;
+      size_t size; ///< Size of the buffer in bytes
+    };
+
+    /**
+     * Set the status of a get and remove it from the pending gets.
+     */
+    void complete(size_t id, int status);
+
+    std::mutex _lock;                           ///< Lock used to protect the members below
+    std::condition_variable _cv;                ///< Notified when a get is completed
+    size_t _nextId{0};                          ///< Id of the next get
+    std::map<size_t, std::string> _pending;     ///< Names of the gets not completed yet by id
+    std::map<std::string, std::string> _errors; ///< Error messages of failed gets by pv name
+  };
+} // namespace ChimeraTK
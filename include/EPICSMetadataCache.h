@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+/*
+ * EPICSMetadataCache.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <map>
+#include <string>
+
+namespace ChimeraTK {
+
+  /**
+   * Meta data of a channel needed to fill the catalogue and to set up the accessors.
+   */
+  struct EpicsChannelMetadata {
+    unsigned long nElems{0};
+    long dbfType{0};
+    bool readable{false};
+    bool writable{false};
+
+    bool operator==(const EpicsChannelMetadata& other) const {
+      return nElems == other.nElems && dbfType == other.dbfType && readable == other.readable &&
+          writable == other.writable;
+    }
+    bool operator!=(const EpicsChannelMetadata& other) const { return !(*this == other); }
+  };
+
+  /**
+   * File based cache of the channel meta data. It allows to fill the catalogue without waiting for the channels to
+   * connect.
+   *
+   * The file starts with a line containing the name of the map file, followed by one line per pv:
+   *
+   *     # map <map file name>
+   *     <pv name> <number of elements> <dbf type> <readable> <writable>
+   *
+   * A cache written for another map file is ignored.
+   */
+  class EpicsMetadataCache {
+   public:
+    /**
+     * Constructor. Reads the cache file if it exists.
+     *
+     * \param fileName The cache file.
+     * \param mapFile The map file used by the backend.
+     */
+    EpicsMetadataCache(const std::string& fileName, const std::string& mapFile);
+
+    /**
+     * Get the cached meta data of a pv.
+     *
+     * \return False if the pv is not in the cache.
+     */
+    bool get(const std::string& pvName, EpicsChannelMetadata& metadata) const;
+
+    /**
+     * Set the meta data of a pv. The file is only written by save().
+     */
+    void set(const std::string& pvName, const EpicsChannelMetadata& metadata);
+
+    /**
+     * Write the cache file if the content changed since it was read or written last.
+     * The file is replaced atomically, so concurrent readers never see a partial file.
+     *
+     * \throw ChimeraTK::runtime_error if the file can not be written.
+     */
+    void save();
+
+   private:
+    std::string _fileName;
+    std::string _mapFile;
+    std::map<std::string, EpicsChannelMetadata> _entries;
+    bool _changed{false}; ///< Content differs from the file
+  };
+} // namespace ChimeraTK
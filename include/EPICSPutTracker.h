@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+/*
+ * EPICSPutTracker.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <cadef.h>
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ChimeraTK {
+
+  /**
+   * Tracks put requests sent with ca_array_put_callback until the server confirmed them. Without callback the puts are
+   * sent with ca_array_put and only errors returned when sending the request are recorded.
+   *
+   * It is used to send the puts of multiple accessors before waiting for all of them once, while the status is still
+   * known for each put. Each pending request keeps the tracker alive, so it is safe to give up waiting after a timeout.
+   *
+   * For asynchronous writes one tracker is used for all puts of a backend. Nobody waits for the completion in that
+   * case: errors are collected per pv and taken by the next transfer (see takeError()), and waitForCapacity() is used
+   * to limit the number of puts in flight.
+   */
+  class EpicsPutTracker : public std::enable_shared_from_this<EpicsPutTracker> {
+   public:
+    /**
+     * \param callback If false, puts are not confirmed by the server and wait() returns immediately.
+     */
+    explicit EpicsPutTracker(bool callback = true) : _callback(callback) {}
+
+    /**
+     * Send a put request. The send buffer is not flushed, call ca_flush_io or ca_pend_io after sending all requests.
+     *
+     * \param type The DBR type of the value.
+     * \param count Number of elements.
+     * \param chid The channel id.
+     * \param value Pointer to the value. It is copied by channel access before the function returns.
+     * \param name Name of the pv. It is used to report the status of the put.
+     * \return The status returned by ca_array_put_callback or ca_array_put.
+     */
+    int put(long type, unsigned long count, chanId chid, const void* value, const std::string& name);
+
+    /**
+     * Wait until all puts are completed.
+     *
+     * \param timeout Timeout in seconds.
+     * \return False in case of a timeout.
+     */
+    bool wait(double timeout);
+
+    /**
+     * Wait until less than maxPending puts are not completed.
+     *
+     * \param maxPending Maximum number of puts in flight.
+     * \param timeout Timeout in seconds.
+     * \return False in case of a timeout.
+     */
+    bool waitForCapacity(size_t maxPending, double timeout);
+
+    /**
+     * Check that all puts completed successfully.
+     *
+     * \throw ChimeraTK::runtime_error naming the failed and not yet completed puts.
+     */
+    void checkErrors();
+
+    /**
+     * Get and clear the error of the last failed put of a pv.
+     *
+     * \param name Name of the pv.
+     * \return The channel access error message or an empty string if no put failed.
+     */
+    std::string takeError(const std::string& name);
+
+   private:
+    /**
+     * Handler called by channel access once a put is completed.
+     * The usr pointer is a Request allocated in put().
+     */
+    static void putHandler(evargs args);
+
+    struct Request {
+      std::shared_ptr<EpicsPutTracker> tracker;
+      size_t id;
+    };
+
+    /**
+     * Set the status of a put and remove it from the pending puts.
+     */
+    void complete(size_t id, int status);
+
+    const bool _callback;                       ///< Puts are sent with ca_array_put_callback
+    std::mutex _lock;                           ///< Lock used to protect the members below
+    std::condition_variable _cv;                ///< Notified when a put is completed
+    size_t _nextId{0};                          ///< Id of the next put
+    std::map<size_t, std::string> _pending;     ///< Names of the puts not completed yet by id
+    std::map<std::string, std::string> _errors; ///< Error messages of failed puts by pv name
+  };
+} // namespace ChimeraTK
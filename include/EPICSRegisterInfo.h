@@ -13,6 +13,15 @@
 
 namespace ChimeraTK {
 
+  /**
+   * Write mode of a register. It is set by the option writeMode in the map file or the CDD.
+   */
+  enum class EpicsWriteMode {
+    sync,      ///< Send the put with ca_array_put and flush it, the completion is not confirmed by the server
+    confirmed, ///< Send the put with ca_array_put_callback and wait until the server confirmed it
+    async      ///< Return after sending the put, errors are reported by the next transfer
+  };
+
   struct EpicsBackendRegisterInfo : public BackendRegisterInfoBase {
     EpicsBackendRegisterInfo(const RegisterPath& path) : _name(path) {};
     EpicsBackendRegisterInfo() = default;
@@ -43,6 +52,10 @@ namespace ChimeraTK {
     AccessModeFlags _accessModes{};
     unsigned int _nElements{};
     long _dbfType{};
+    EpicsWriteMode _writeMode{EpicsWriteMode::sync}; ///< How writes are sent and confirmed
+    bool _isConfigured{false};                       ///< Meta data (type, number of elements, access rights) is filled
+    size_t _queueLength{3};                          ///< Length of the notification queue with wait_for_new_data
+    bool _lossless{false};                           ///< Monitor events in the notification queue are never overwritten
 
     // this is needed because the name inside _pv is just a pointer
     std::string _caName;
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+/*
+ * EPICSTransferBatch.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <ChimeraTK/TransferElement.h>
+
+#include <mutex>
+#include <vector>
+
+namespace ChimeraTK {
+  class EpicsBackend;
+  class EpicsBackendRegisterAccessorBase;
+
+  /**
+   * Low level transfer element used by the synchronous EpicsBackendRegisterAccessors. It is returned by
+   * getHardwareAccessingElements of the accessors, so a TransferGroup only transfers the batch. Accessors of the same
+   * backend added to a TransferGroup are merged into one batch (see
+   * EpicsBackendRegisterAccessor::replaceTransferElement). The batch issues the requests of all its accessors before
+   * waiting for them once, so reading or writing a group takes about one network round trip. Writes of registers in
+   * write mode confirmed use ca_array_put_callback, so the completion status is still reported for each channel (see
+   * EpicsPutTracker).
+   *
+   * Transfers of single accessors outside of a TransferGroup do not use the batch. Accessors only forward
+   * preRead/postRead and preWrite/postWrite to it, so exceptions of the batch transfer are reported by the accessors.
+   */
+  class EpicsTransferBatch : public TransferElement {
+   public:
+    explicit EpicsTransferBatch(boost::shared_ptr<EpicsBackend> backend);
+
+    /**
+     * Add accessor to the batch.
+     */
+    void add(EpicsBackendRegisterAccessorBase* accessor);
+
+    /**
+     * Remove accessor from the batch. Called in the destructor of the accessor.
+     */
+    void remove(EpicsBackendRegisterAccessorBase* accessor);
+
+    /**
+     * Move all accessors of the other batch to this batch. The _batch member of the moved accessors is updated.
+     * \remark Only to be used while setting up a TransferGroup, i.e. no transfer is running.
+     */
+    void merge(EpicsTransferBatch& other);
+
+    /**
+     * Check if accessors of the given backend can be merged into this batch.
+     */
+    bool isMergeable(const boost::shared_ptr<EpicsBackend>& backend) const { return backend == _backend; }
+
+    void doReadTransferSynchronously() override;
+
+    bool doWriteTransfer(VersionNumber versionNumber = {}) override;
+
+    bool isReadOnly() const override { return false; }
+
+    bool isReadable() const override { return true; }
+
+    bool isWriteable() const override { return true; }
+
+    const std::type_info& getValueType() const override { return typeid(void); }
+
+    std::vector<boost::shared_ptr<TransferElement>> getHardwareAccessingElements() override {
+      return {boost::enable_shared_from_this<TransferElement>::shared_from_this()};
+    }
+
+    std::list<boost::shared_ptr<TransferElement>> getInternalElements() override { return {}; }
+
+    void replaceTransferElement(boost::shared_ptr<TransferElement> /*newElement*/) override {} // LCOV_EXCL_LINE
+
+   private:
+    boost::shared_ptr<EpicsBackend> _backend;
+    std::mutex _lock;                                          ///< Lock used to protect the accessor list
+    std::vector<EpicsBackendRegisterAccessorBase*> _accessors; ///< Accessors transferred by the batch
+  };
+} // namespace ChimeraTK
@@ -12,8 +12,8 @@
 
 #include <epicsTime.h>
 
+#include <array>
 #include <chrono>
-#include <map>
 #include <mutex>
 
 using timePoint_t = std::chrono::time_point<std::chrono::system_clock, std::chrono::duration<int64_t, std::nano>>;
@@ -23,10 +23,17 @@ namespace EPICS {
    * This class is needed, because if two accessors are create and receive the same data from the server their
    * VersionNumber is required to be identical. Since the VersionNumber is not identical just because it is created
    * with the same time stamp this VersionMapper is needed. It takes care of holding a global map that connects source
-   * time stamps attached  to OPC UA data to ChimeraTK::VersionNumber.
+   * time stamps attached to EPICS data to ChimeraTK::VersionNumber.
    *
-   * It assumes that OPC UA source time stamps are unique.
+   * It assumes that EPICS time stamps are unique.
    * \ToDo: Does every accessor needs it own VersionNumber history??
+   *
+   * The map is split into shards with their own lock, so accessors reading concurrently rarely wait for each other.
+   * Each shard keeps the versions of its ringSize most recent time stamps: a ring holds the time stamps in the order
+   * they were added, and a small hash table maps them to their version. A new time stamp replaces the oldest one of
+   * its shard. So the same time stamp always gets the same VersionNumber as long as it is one of the ringSize most
+   * recent time stamps of its shard, i.e. of about the nShards * ringSize most recent time stamps. Older time stamps
+   * get a new VersionNumber.
    */
   class VersionMapper {
    public:
@@ -43,11 +50,34 @@ namespace EPICS {
     VersionMapper(const VersionMapper&) = delete;
     VersionMapper& operator=(const VersionMapper&) = delete;
 
-    std::mutex _mapMutex; ///< Lock used to protect the _versionMap
-    std::map<int64_t, ChimeraTK::VersionNumber> _versionMap{};
+    constexpr static size_t nShards = 64;             ///< Number of independently locked parts of the map
+    constexpr static size_t ringSize = 64;            ///< Number of time stamps kept per shard
+    constexpr static size_t tableSize = 2 * ringSize; ///< Number of hash table entries per shard, a power of two
 
-    const int64_t _epicsTimeOffset{631152000}; ///< Offest to be applied since epics counts seconds since 1990
+    struct Entry {
+      int64_t timeStamp{0}; ///< Nanoseconds since 1970
+      bool used{false};
+      ChimeraTK::VersionNumber version{nullptr};
+    };
+
+    /** Part of the map. Aligned to avoid false sharing between the locks of different shards. */
+    struct alignas(64) Shard {
+      std::mutex lock; ///< Lock used to protect the members below
+      /** Hash table with linear probing. At most ringSize entries are used. */
+      std::array<Entry, tableSize> table;
+      std::array<int64_t, ringSize> ring; ///< Time stamps of the table in the order they were added
+      size_t next{0};                     ///< Position in the ring of the next time stamp
+      size_t size{0};                     ///< Number of time stamps in the ring
 
-    constexpr static size_t maxSizeEventIdMap = 2000;
+      /**
+       * Remove the entry at the given position of the table. Following entries are moved back, so lookups do not stop
+       * at the free entry.
+       */
+      void erase(size_t index);
+    };
+
+    std::array<Shard, nShards> _shards;
+
+    const int64_t _epicsTimeOffset{631152000}; ///< Offest to be applied since epics counts seconds since 1990
   };
 } // namespace EPICS
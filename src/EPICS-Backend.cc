@@ -19,9 +19,9 @@
 
 #include <cadef.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <thread>
 #include <vector>
 typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
 
@@ -31,7 +31,9 @@ boost::shared_ptr<ChimeraTK::DeviceBackend> ChimeraTK_DeviceAccess_createBackend
   return ChimeraTK::EpicsBackend::createInstance(address, parameters);
 }
 
-std::vector<std::string> ChimeraTK_DeviceAccess_sdmParameterNames{"map"};
+std::vector<std::string> ChimeraTK_DeviceAccess_sdmParameterNames{
+    "map", "writeMode", "maxPendingWrites", "cachedReadMaxAge", "lazyConnect", "metadataCache", "partialOpenTimeout",
+    "caContexts", "queueLength", "lossless", "sharedDecoding"};
 
 std::string ChimeraTK_DeviceAccess_version{CHIMERATK_DEVICEACCESS_VERSION};
 
@@ -41,8 +43,47 @@ std::string backend_name = "epics";
 namespace ChimeraTK {
   EpicsBackend::BackendRegisterer EpicsBackend::backendRegisterer;
 
-  EpicsBackend::EpicsBackend(const std::string& mapfile) : _catalogue_filled(false), _freshCreated(true) {
+  EpicsBackend::EpicsBackend(const std::string& mapfile, std::map<std::string, std::string> parameters)
+  : _catalogue_filled(false), _freshCreated(true) {
     FILL_VIRTUAL_FUNCTION_TEMPLATE_VTABLE(getRegisterAccessor_impl);
+    if(!parameters["writeMode"].empty()) {
+      _writeMode = parseWriteMode(parameters["writeMode"]);
+    }
+    if(!parameters["maxPendingWrites"].empty()) {
+      _maxPendingWrites = parseNumber("maxPendingWrites", parameters["maxPendingWrites"]);
+      if(_maxPendingWrites == 0) {
+        throw ChimeraTK::logic_error("maxPendingWrites has to be larger than 0.");
+      }
+    }
+    if(!parameters["queueLength"].empty()) {
+      _queueLength = parseQueueLength(parameters["queueLength"]);
+    }
+    if(!parameters["lossless"].empty()) {
+      _lossless = parseNumber("lossless", parameters["lossless"]) != 0;
+    }
+    if(!parameters["sharedDecoding"].empty()) {
+      _sharedDecoding = parseNumber("sharedDecoding", parameters["sharedDecoding"]) != 0;
+    }
+    if(!parameters["cachedReadMaxAge"].empty()) {
+      _cachedReads = true;
+      _cachedReadMaxAge = std::chrono::milliseconds(parseNumber("cachedReadMaxAge", parameters["cachedReadMaxAge"]));
+    }
+    if(!parameters["lazyConnect"].empty()) {
+      _lazyConnect = parseNumber("lazyConnect", parameters["lazyConnect"]) != 0;
+    }
+    if(!parameters["partialOpenTimeout"].empty()) {
+      _partialOpen = true;
+      _partialOpenTimeout = parseNumber("partialOpenTimeout", parameters["partialOpenTimeout"]) / 1000.;
+    }
+    if(!parameters["caContexts"].empty()) {
+      _nContexts = parseNumber("caContexts", parameters["caContexts"]);
+      if(_nContexts == 0) {
+        throw ChimeraTK::logic_error("caContexts has to be larger than 0.");
+      }
+    }
+    if(!parameters["metadataCache"].empty()) {
+      _metadataCache = std::make_unique<EpicsMetadataCache>(parameters["metadataCache"], mapfile);
+    }
     prepareChannelAccess();
 
     fillCatalogueFromMapFile(mapfile);
@@ -52,54 +93,81 @@ namespace ChimeraTK {
   EpicsBackend::~EpicsBackend() {
     _asyncReadActivated = false;
     close();
-    ChannelManager::getInstance().cleanup();
+    updateMetadataCache();
+    _channelManager.cleanup();
   }
 
   void EpicsBackend::prepareChannelAccess() {
-    // introduced to run the unit tests
-    // \ToDo: Why is that needed - each test finishes with closing the device which should destroy the context already
+    // the context the thread is attached to might belong to another backend or to the application - keep it
     if(ca_current_context()) {
-      ca_context_destroy();
+      ca_detach_context();
+    }
+    _caContexts.clear();
+    for(size_t i = 0; i < _nContexts; ++i) {
+      // each context has its own circuits and auxiliary threads, so callbacks of different contexts run in parallel
+      auto result = ca_context_create(ca_enable_preemptive_callback);
+      if(result != ECA_NORMAL) {
+        std::stringstream ss;
+        ss << "CA error " << ca_message(result) << "occurred while trying to start channel access.";
+        throw ChimeraTK::runtime_error(ss.str());
+      }
+      _caContexts.push_back(ca_current_context());
+      ca_detach_context();
     }
-    auto result = ca_context_create(ca_enable_preemptive_callback);
+    attachContext();
+  }
+
+  void EpicsBackend::attachContext(size_t shard) {
+    if(shard >= _caContexts.size()) return;
+    auto current = ca_current_context();
+    if(current == _caContexts[shard]) return;
+    if(current) {
+      ca_detach_context();
+    }
+    auto result = ca_attach_context(_caContexts[shard]);
     if(result != ECA_NORMAL) {
       std::stringstream ss;
-      ss << "CA error " << ca_message(result) << "occurred while trying to start channel access.";
+      ss << "CA error " << ca_message(result) << " occurred while trying to attach to the channel access context.";
       throw ChimeraTK::runtime_error(ss.str());
     }
   }
 
+  size_t EpicsBackend::getShard(const std::string& caName) const {
+    if(_nContexts == 1) return 0;
+    return std::hash<std::string>{}(caName) % _nContexts;
+  }
+
+  void EpicsBackend::flushIO() {
+    for(size_t i = 0; i < _caContexts.size(); ++i) {
+      attachContext(i);
+      ca_flush_io();
+    }
+  }
+
   void EpicsBackend::open() {
     if(!isFunctional()) {
       // after closing a new ca_context is needed (_opened is set also in constructor to signal prepareChannelAccess was
       // just called before)
-      if(!_freshCreated) {
+      // the context is kept when recovering from an exception, so connected channels and their subscriptions stay
+      // intact and only disconnected channels are reconnected by channel access
+      if(!_freshCreated && _contextDestroyed) {
         prepareChannelAccess();
-        {
-          std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-          ChannelManager::getInstance().addChannelsFromMap(this);
-        }
-      }
-      else {
-        _freshCreated = false;
-      }
-      size_t n = default_ca_timeout / 0.1; // sleep 100ms per loop, wait default_ca_timeout until giving up
-      for(size_t i = 0; i < n; i++) {
-        {
-          std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-          if(ChannelManager::getInstance().checkAllConnections(true)) {
-            _channelAccessUp = true;
-            break;
-          }
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        _channelManager.addChannelsFromMap(this);
+        _contextDestroyed = false;
+        // puts pending when closing the backend are never completed, so start with an empty tracker
+        _asyncWrites = std::make_shared<EpicsPutTracker>();
       }
-      if(!_channelAccessUp) {
-        throw ChimeraTK::runtime_error("Failed to establish channel access connection.");
+      else if(!_freshCreated) {
+        // the connection state was reset when the exception was reported
+        _channelManager.updateConnectionState();
       }
+      _freshCreated = false;
+      attachContext();
+      waitForChannels();
+      updateCatalogue();
+      updateMetadataCache();
       if(_asyncReadActivated) {
-        std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-        ChannelManager::getInstance().activateChannels();
+        _channelManager.activateChannels();
       }
       _startVersion = {};
       setOpenedAndClearException();
@@ -109,33 +177,52 @@ namespace ChimeraTK {
   void EpicsBackend::close() {
     _opened = false;
     _asyncReadActivated = false;
-    std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-    ChannelManager::getInstance().deactivateChannels();
-    ChannelManager::getInstance().resetConnectionState();
-    ca_context_destroy();
+    if(_caContexts.empty()) return;
+    _channelManager.deactivateChannels();
+    _channelManager.resetConnectionState();
+    for(size_t i = 0; i < _caContexts.size(); ++i) {
+      // destroys the context the thread is attached to
+      attachContext(i);
+      ca_context_destroy();
+    }
+    _caContexts.clear();
+    _contextDestroyed = true;
+  }
+
+  void EpicsBackend::waitForChannels() {
+    if(_channelManager.waitForAllConnections(_partialOpen ? _partialOpenTimeout : default_ca_timeout)) {
+      _channelAccessUp = true;
+    }
+    else if(_partialOpen) {
+      std::cerr << "Not all channels are connected. They are used as soon as they connect." << std::endl;
+      return;
+    }
+    if(!_channelAccessUp) {
+      throw ChimeraTK::runtime_error("Failed to establish channel access connection.");
+    }
   }
 
   void EpicsBackend::activateAsyncRead() noexcept {
     if(!isFunctional()) return;
-    // activate async read expects an initial value so deactivate channels first to force initial value
-    {
-      std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-      ChannelManager::getInstance().deactivateChannels();
-      ChannelManager::getInstance().activateChannels();
-    }
-    size_t n = default_ca_timeout / 0.1; // sleep 100ms per loop, wait default_ca_timeout until giving up
-    bool allGood = false;
-    for(size_t i = 0; i < n; i++) {
-      if(ChannelManager::getInstance().checkInitialValueReceived()) {
-        allGood = true;
-        break;
+    attachContext();
+    // activate async read expects an initial value so suspend channels first to force initial value
+    // resuming a subscription sends the last event as initial value without contacting the server
+    _channelManager.suspendChannels();
+    try {
+      // in partial open mode unconnected channels are activated once they connect (see channelStateHandler)
+      _channelManager.activateChannels(_partialOpen);
+      if(!_channelManager.waitForInitialValues(default_ca_timeout)) {
+        std::cerr << "Failed to receive initial value for all subscriptions in activateAsyncRead()." << std::endl;
+      }
+      _asyncReadActivated = true;
+      if(_partialOpen) {
+        // activate channels that connected before _asyncReadActivated was set
+        _channelManager.activateChannels(true);
       }
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
-    if(!allGood) {
-      std::cerr << "Failed to receive initial value for all subscriptions in activateAsyncRead()." << std::endl;
+    catch(ChimeraTK::runtime_error& e) {
+      setException(e.what());
     }
-    _asyncReadActivated = true;
   }
 
   template<typename UserType>
@@ -143,7 +230,15 @@ namespace ChimeraTK {
       const RegisterPath& registerPathName, size_t numberOfWords, size_t wordOffsetInRegister, AccessModeFlags flags) {
     RegisterPath path = "EPICS://" + registerPathName;
 
-    EpicsBackendRegisterInfo info = _catalogue_mutable.getBackendRegister(registerPathName);
+    EpicsBackendRegisterInfo info;
+    {
+      std::lock_guard<std::mutex> lock(_connectLock);
+      info = _catalogue_mutable.getBackendRegister(registerPathName);
+    }
+    attachContext();
+    // registers not configured yet are connected first, e.g. in lazy connect mode or if the channel was not connected
+    // when opening in partial open mode
+    if(_lazyConnect || !info._isConfigured) connectRegister(info);
 
     if(numberOfWords + wordOffsetInRegister > info._nElements || (numberOfWords == 0 && wordOffsetInRegister > 0)) {
       std::stringstream ss;
@@ -203,7 +298,9 @@ namespace ChimeraTK {
   }
 
   EpicsBackend::BackendRegisterer::BackendRegisterer() {
-    BackendFactory::getInstance().registerBackendType("epics", &EpicsBackend::createInstance, {"map"});
+    BackendFactory::getInstance().registerBackendType("epics", &EpicsBackend::createInstance,
+        {"map", "writeMode", "maxPendingWrites", "cachedReadMaxAge", "lazyConnect", "metadataCache",
+            "partialOpenTimeout", "caContexts", "queueLength", "lossless", "sharedDecoding"});
     std::cout << "BackendRegisterer: registered backend type epics" << std::endl;
   }
 
@@ -212,15 +309,21 @@ namespace ChimeraTK {
     if(parameters["map"].empty()) {
       throw ChimeraTK::logic_error("No map file provided.");
     }
-    return boost::shared_ptr<DeviceBackend>(new EpicsBackend(parameters["map"]));
+    return boost::shared_ptr<DeviceBackend>(new EpicsBackend(parameters["map"], parameters));
   }
 
-  void EpicsBackend::addCatalogueEntry(RegisterPath path, std::shared_ptr<std::string> pvName) {
-    EpicsBackendRegisterInfo info(path);
-    info._caName = std::string(*pvName.get());
+  void EpicsBackend::addCatalogueEntry(EpicsBackendRegisterInfo info) {
+    EpicsChannelMetadata metadata;
+    if(_metadataCache && _metadataCache->get(info._caName, metadata)) {
+      fillRegisterInfo(info, metadata);
+    }
+    if(_lazyConnect) {
+      // the channel is created when the register is used, see connectRegister()
+      _catalogue_mutable.addRegister(info);
+      return;
+    }
     try {
-      std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-      ChannelManager::getInstance().addChannel(info._caName, this);
+      createChannel(info._caName);
     }
     catch(ChimeraTK::runtime_error& e) {
       std::cerr << e.what() << ". PV is not added to the catalog." << std::endl;
@@ -230,26 +333,30 @@ namespace ChimeraTK {
   }
 
   void EpicsBackend::configureChannel(EpicsBackendRegisterInfo& info) {
-    std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-    auto pv = ChannelManager::getInstance().getPV(info._caName);
-    if(!ChannelManager::getInstance().isChannelConfigured(info._caName)) {
+    EpicsChannelMetadata metadata;
+    if(!_channelManager.getMetadata(info._caName, metadata)) {
       throw ChimeraTK::runtime_error("Trying to read an unconfigured channel.");
     }
-    info._nElements = pv->nElems;
-    info._dbfType = pv->dbfType;
+    fillRegisterInfo(info, metadata);
+  }
+
+  void EpicsBackend::fillRegisterInfo(EpicsBackendRegisterInfo& info, const EpicsChannelMetadata& metadata) {
+    info._nElements = metadata.nElems;
+    info._dbfType = metadata.dbfType;
+    info._isConfigured = true;
 
-    if(ca_read_access(pv->chid) != 1) info._isReadable = false;
-    if(ca_write_access(pv->chid) != 1) info._isWritable = false;
-    if(pv->dbfType == DBF_STRING) {
+    info._isReadable = metadata.readable;
+    info._isWritable = metadata.writable;
+    if(metadata.dbfType == DBF_STRING) {
       info._dataDescriptor = DataDescriptor(DataDescriptor::FundamentalType::string, true, true, 320, 300);
     }
-    else if(pv->dbfType == DBF_DOUBLE || pv->dbfType == DBF_FLOAT) {
+    else if(metadata.dbfType == DBF_DOUBLE || metadata.dbfType == DBF_FLOAT) {
       info._dataDescriptor = DataDescriptor(DataDescriptor::FundamentalType::numeric, false, true, 320, 300);
     }
-    else if(pv->dbfType == DBF_INT || pv->dbfType == DBF_LONG || pv->dbfType == DBF_SHORT) {
+    else if(metadata.dbfType == DBF_INT || metadata.dbfType == DBF_LONG || metadata.dbfType == DBF_SHORT) {
       info._dataDescriptor = DataDescriptor(DataDescriptor::FundamentalType::numeric, true, true, 320, 300);
     }
-    else if(pv->dbfType == DBF_ENUM) {
+    else if(metadata.dbfType == DBF_ENUM) {
       info._dataDescriptor = DataDescriptor(DataDescriptor::FundamentalType::boolean, true, true, 320, 300);
     }
     else {
@@ -258,6 +365,42 @@ namespace ChimeraTK {
     info._accessModes.add(AccessMode::wait_for_new_data);
   }
 
+  void EpicsBackend::createChannel(const std::string& caName) {
+    _channelManager.addChannel(caName, this);
+    EpicsChannelMetadata metadata;
+    if(_metadataCache && _metadataCache->get(caName, metadata)) {
+      _channelManager.configureChannel(caName, metadata);
+    }
+  }
+
+  void EpicsBackend::updateCatalogue() {
+    std::lock_guard<std::mutex> lock(_connectLock);
+    for(auto& reg : _catalogue_mutable) {
+      // e.g. the access rights or the layout changed since the register was configured from the metadata cache
+      if(reg._isConfigured && _channelManager.hasChannel(reg._caName) &&
+          _channelManager.isChannelConfigured(reg._caName)) {
+        configureChannel(reg);
+      }
+    }
+  }
+
+  void EpicsBackend::updateMetadataCache() {
+    if(!_metadataCache) return;
+    std::lock_guard<std::mutex> lock(_connectLock);
+    EpicsChannelMetadata metadata;
+    for(auto& reg : _catalogue_mutable) {
+      if(_channelManager.hasChannel(reg._caName) && _channelManager.getServerMetadata(reg._caName, metadata)) {
+        _metadataCache->set(reg._caName, metadata);
+      }
+    }
+    try {
+      _metadataCache->save();
+    }
+    catch(ChimeraTK::runtime_error& e) {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+
   void EpicsBackend::fillCatalogueFromMapFile(const std::string& mapfileName) {
     boost::char_separator<char> sep{"\t ", "", boost::drop_empty_tokens};
     std::string line;
@@ -267,7 +410,7 @@ namespace ChimeraTK {
         if(line.empty()) continue;
         tokenizer tok{line, sep};
         size_t nTokens = std::distance(tok.begin(), tok.end());
-        if(!(nTokens == 2)) {
+        if(nTokens < 2) {
           std::cerr << "Wrong number of tokens (" << nTokens << ") in mapfile " << mapfileName
                     << " line (-> line is ignored): \n " << line << std::endl;
           continue;
@@ -278,13 +421,42 @@ namespace ChimeraTK {
           std::shared_ptr<std::string> pathStr = std::make_shared<std::string>(*it);
           RegisterPath path(*(pathStr.get()));
           it++;
-          std::shared_ptr<std::string> nodeName = std::make_shared<std::string>(*it);
-          addCatalogueEntry(path, nodeName);
+          EpicsBackendRegisterInfo info(path);
+          info._caName = *it;
+          info._writeMode = _writeMode;
+          size_t queueLength = _queueLength;
+          info._lossless = _lossless;
+          // optional tokens: writeMode=sync|confirmed|async, queueLength=<n>, lossless=0|1
+          for(it++; it != tok.end(); it++) {
+            std::string option(*it);
+            auto pos = option.find('=');
+            std::string key = option.substr(0, pos);
+            std::string value = pos == std::string::npos ? "" : option.substr(pos + 1);
+            if(key == "writeMode") {
+              info._writeMode = parseWriteMode(value);
+            }
+            else if(key == "queueLength") {
+              queueLength = parseQueueLength(value);
+            }
+            else if(key == "lossless") {
+              info._lossless = parseNumber("lossless", value) != 0;
+            }
+            else {
+              throw ChimeraTK::logic_error("Unknown option " + option);
+            }
+          }
+          if(queueLength == 0) queueLength = info._lossless ? defaultLosslessQueueLength : defaultQueueLength;
+          info._queueLength = queueLength;
+          addCatalogueEntry(info);
         }
         catch(std::out_of_range& e) {
           std::cerr << "Failed reading the following line from mapping file " << mapfileName << "\n " << line
                     << std::endl;
         }
+        catch(ChimeraTK::logic_error& e) {
+          std::cerr << e.what() << " in mapfile " << mapfileName << " line (-> line is ignored): \n " << line
+                    << std::endl;
+        }
       }
       mapfile.close();
     }
@@ -295,32 +467,70 @@ namespace ChimeraTK {
     if(_catalogue_mutable.getNumberOfRegisters() == 0) {
       throw ChimeraTK::runtime_error("No registers found in catalogue!");
     }
-
-    auto result = ca_flush_io();
-    if(result == ECA_TIMEOUT) {
-      throw ChimeraTK::runtime_error("Channel setup failed.");
+    if(_lazyConnect) return;
+
+    flushIO();
+    // registers found in the metadata cache are configured already, the channels connect in the background
+    bool allConfigured = std::all_of(_catalogue_mutable.begin(), _catalogue_mutable.end(),
+        [](const EpicsBackendRegisterInfo& reg) { return reg._isConfigured; });
+    if(allConfigured) return;
+    waitForChannels();
+    for(auto& reg : _catalogue_mutable) {
+      // in partial open mode registers of unconnected channels are configured once they are used
+      if(!reg._isConfigured && _channelManager.isChannelConfigured(reg._caName)) {
+        configureChannel(reg);
+      }
     }
-    size_t n = default_ca_timeout / 0.1; // sleep 100ms per loop, wait default_ca_timeout until giving up
-    for(size_t i = 0; i < n; i++) {
-      {
-        std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-        if(ChannelManager::getInstance().checkAllConnections(true)) {
-          _channelAccessUp = true;
-          break;
-        }
+    updateMetadataCache();
+  }
+
+  void EpicsBackend::connectRegister(EpicsBackendRegisterInfo& info) {
+    std::lock_guard<std::mutex> lock(_connectLock);
+    if(!_channelManager.hasChannel(info._caName)) {
+      // the channel access context is destroyed when closing the device
+      if(!_freshCreated && !_opened) {
+        throw ChimeraTK::logic_error(
+            "Register " + info.getRegisterPath() + " can not be connected while the device is closed (lazyConnect).");
       }
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      createChannel(info._caName);
+      flushIO();
     }
-    if(!_channelAccessUp) {
-      throw ChimeraTK::runtime_error("Failed to establish channel access connection.");
+    if(info._isConfigured) return;
+    if(!_channelManager.waitForConnection(info._caName, default_ca_timeout)) {
+      throw ChimeraTK::runtime_error("Failed to establish channel access connection for pv: " + info._caName);
     }
-    for(auto& reg : _catalogue_mutable) {
-      configureChannel(reg);
+    configureChannel(info);
+    _catalogue_mutable.modifyRegister(info);
+  }
+
+  EpicsWriteMode EpicsBackend::parseWriteMode(const std::string& mode) {
+    if(mode == "async") return EpicsWriteMode::async;
+    if(mode == "confirmed") return EpicsWriteMode::confirmed;
+    if(mode == "sync") return EpicsWriteMode::sync;
+    throw ChimeraTK::logic_error("Unknown write mode: " + mode);
+  }
+
+  size_t EpicsBackend::parseQueueLength(const std::string& value) {
+    auto length = parseNumber("queueLength", value);
+    if(length == 0) {
+      throw ChimeraTK::logic_error("queueLength has to be larger than 0.");
+    }
+    return length;
+  }
+
+  size_t EpicsBackend::parseNumber(const std::string& name, const std::string& value) {
+    try {
+      size_t pos;
+      auto number = std::stoul(value, &pos);
+      if(pos == value.size() && value[0] != '-') return number;
+    }
+    catch(std::logic_error&) {
     }
+    throw ChimeraTK::logic_error("Invalid value for " + name + ": " + value);
   }
 
   void EpicsBackend::setExceptionImpl() noexcept {
     _asyncReadActivated = false;
-    ChannelManager::getInstance().setException(std::string("Exception reported by another accessor."));
+    _channelManager.setException(std::string("Exception reported by another accessor."));
   }
 } // namespace ChimeraTK
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/*
+ * EPICSBackendRegisterAccessor.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "EPICSBackendRegisterAccessor.h"
+
+namespace ChimeraTK {
+
+  void EpicsBackendRegisterAccessorBase::readValue() {
+    // also used by partial writes, e.g. of a TransferGroup, so the thread might be attached to another context
+    _backend->attachContext(_channel->_shard);
+    auto tracker = std::make_shared<EpicsGetTracker>();
+    requestRead(*tracker);
+    ca_flush_io();
+    tracker->wait(default_ca_timeout);
+    tracker->checkErrors();
+    finishRead();
+  }
+
+  void EpicsBackendRegisterAccessorBase::checkLayout() {
+    if(_layoutVersion != _channel->_layoutVersion) {
+      throw ChimeraTK::runtime_error("Type or length of pv " + _info._caName + " changed. The accessor of register " +
+          _info.getRegisterPath() + " has to be recreated.");
+    }
+  }
+
+  bool EpicsBackendRegisterAccessorBase::pushLayoutError() {
+    try {
+      checkLayout();
+      return false;
+    }
+    catch(...) {
+      _notifications.push_overwrite_exception(std::current_exception());
+      return true;
+    }
+  }
+
+  void EpicsBackendRegisterAccessorBase::pushEvent(const EpicsRawData& data) {
+    if(pushLayoutError()) return;
+    // events of the previous subscription are still received until the subscription requesting the elements of this
+    // accessor delivers its initial value
+    if(data.count < _offsetWords + _numberOfWords) return;
+    EpicsRawData event(data);
+    event.afterLoss = _eventsDropped;
+    if(_notifications.push(std::move(event))) {
+      _eventsDropped = false;
+      return;
+    }
+    ++_nOverflows;
+    if(_lossless) {
+      _eventsDropped = true;
+      return;
+    }
+    _notifications.push_overwrite(EpicsRawData(data));
+  }
+
+  void EpicsBackendRegisterAccessorBase::writeValue() {
+    bool confirmed = _info._writeMode == EpicsWriteMode::confirmed;
+    auto tracker = std::make_shared<EpicsPutTracker>(confirmed);
+    requestWrite(*tracker);
+    ca_flush_io();
+    if(confirmed) tracker->wait(default_ca_timeout);
+    tracker->checkErrors();
+  }
+
+  void EpicsBackendRegisterAccessorBase::requestAsyncWrite() {
+    auto tracker = _backend->_asyncWrites;
+    if(!tracker->waitForCapacity(_backend->_maxPendingWrites, default_ca_timeout)) {
+      throw ChimeraTK::runtime_error(
+          std::string("Timeout while waiting for pending asynchronous writes when writing pv: ") + _info._caName);
+    }
+    requestWrite(*tracker);
+  }
+
+  EpicsRawData EpicsBackendRegisterAccessorBase::getValueForPartialWrite() {
+    {
+      std::lock_guard<std::mutex> lock(_channel->_lock);
+      // the subscription delivers every change of the value, so the last event is the current value as long as the
+      // channel is connected and it already contains the last put of this backend
+      if(_channel->_asyncReadActivated && _channel->_initialValueReceived && _channel->_connected &&
+          _channel->_lastEvent.size == _readBuffers->getBufferSize()) {
+        std::lock_guard<std::mutex> valueLock(_channel->_valueLock);
+        if(!_channel->_putPending) return _channel->_lastEvent;
+      }
+    }
+    readValue();
+    return _data;
+  }
+
+  void EpicsBackendRegisterAccessorBase::checkAsyncWriteError() {
+    if(_info._writeMode != EpicsWriteMode::async) return;
+    auto error = _backend->_asyncWrites->takeError(_info._caName);
+    if(!error.empty()) {
+      throw ChimeraTK::runtime_error("Asynchronous write failed for pv: " + _info._caName + " (" + error + ")");
+    }
+  }
+
+  void EpicsBackendRegisterAccessorBase::requestRead(EpicsGetTracker& tracker) {
+    auto pv = _channel->_pv;
+    // one could also use ChannelManager::isChannelConnected -> however we ask explicitly ChannelAccess here
+    if(ca_state(pv->chid) != cs_conn) {
+      throw ChimeraTK::runtime_error(
+          std::string("ChannelAccess not connected in doReadTransferSynchronously when writing: ") + _info._name + "(" +
+          pv->name + ")");
+    }
+    // release the last payload, so its buffer can be reused
+    _data = {};
+    _pendingRead = _readBuffers->get();
+    auto result = tracker.get(pv->dbrType, pv->nElems, pv->chid, _pendingRead, _info._caName);
+    if(result != ECA_NORMAL) {
+      throw ChimeraTK::runtime_error(std::string("Failed to read pv: ") + pv->name + " (" + ca_message(result) + ")");
+    }
+  }
+
+  bool EpicsBackendRegisterAccessorBase::readCachedValue() {
+    if(!_backend->_cachedReads) return false;
+    std::lock_guard<std::mutex> lock(_channel->_lock);
+    if(!_channel->_asyncReadActivated || !_channel->_initialValueReceived || !_channel->_connected) return false;
+    if(std::chrono::steady_clock::now() - _channel->_lastEventTime > _backend->_cachedReadMaxAge) return false;
+    // the subscription might request only the first elements of the array
+    if(_channel->_lastEvent.count < _offsetWords + _numberOfWords) return false;
+    _data = _channel->_lastEvent;
+    return true;
+  }
+
+  void EpicsBackendRegisterAccessorBase::finishRead() {
+    _data.data = std::move(_pendingRead);
+    _data.size = _readBuffers->getBufferSize();
+    _data.count = _channel->_pv->nElems;
+  }
+
+} // namespace ChimeraTK
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/*
+ * EPICSBufferPool.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "EPICSBufferPool.h"
+
+namespace ChimeraTK {
+
+  EpicsBufferPool::EpicsBufferPool(size_t bufferSize, size_t capacity)
+  : _bufferSize(bufferSize), _capacity(capacity) {
+    _buffers.reserve(capacity);
+  }
+
+  std::shared_ptr<void> EpicsBufferPool::get() {
+    std::lock_guard<std::mutex> lock(_lock);
+    ++_nRequests;
+    for(size_t i = 0; i < _buffers.size(); ++i) {
+      size_t index = (_next + i) % _buffers.size();
+      if(_buffers[index].use_count() == 1) {
+        // make sure all accesses of the previous user of the buffer are finished
+        std::atomic_thread_fence(std::memory_order_acquire);
+        _next = (index + 1) % _buffers.size();
+        return _buffers[index];
+      }
+    }
+    ++_nAllocations;
+    std::shared_ptr<void> buffer(::operator new(_bufferSize), [](void* p) { ::operator delete(p); });
+    if(_buffers.size() < _capacity) {
+      _buffers.push_back(buffer);
+    }
+    return buffer;
+  }
+
+  void EpicsBufferPool::setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _capacity = capacity;
+    // buffers still in use are kept until the capacity is increased again
+    for(auto it = _buffers.begin(); it != _buffers.end() && _buffers.size() > capacity;) {
+      if(it->use_count() == 1) {
+        it = _buffers.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+    _next = 0;
+  }
+
+  size_t EpicsBufferPool::getMemory() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _buffers.size() * _bufferSize;
+  }
+} // namespace ChimeraTK
@@ -13,14 +13,53 @@
 
 #include <cadef.h>
 
+#include <algorithm>
+#include <iostream>
+
 namespace ChimeraTK {
 
   ChannelInfo::ChannelInfo(std::string channelName) {
-    _pv.reset((pv*)calloc(1, sizeof(pv)), free);
+    _pv.reset((pv*)calloc(1, sizeof(pv)), [](pv* p) {
+      free(p->value);
+      free(p);
+    });
     _caName = channelName;
     _pv->name = (char*)_caName.c_str();
   }
 
+  void* ChannelInfo::getWriteBuffer() {
+    if(!_pv->value) {
+      // a complete DBR_TIME payload, so the result of a read can be copied into it
+      _writeBufferSize = dbr_size_n(_pv->dbrType, _pv->nElems);
+      _pv->value = calloc(1, _writeBufferSize);
+    }
+    return _pv->value;
+  }
+
+  void ChannelInfo::configure(const EpicsChannelMetadata& metadata) {
+    free(_pv->value);
+    _pv->value = nullptr;
+    _writeBufferSize = 0;
+    _putInWriteBuffer = false;
+    _metadata = metadata;
+    _pv->nElems = metadata.nElems;
+    _pv->dbfType = metadata.dbfType;
+    _pv->dbrType = dbf_type_to_DBR_TIME(metadata.dbfType);
+    _configured = true;
+  }
+
+  void ChannelInfo::checkPutReceived(const EpicsRawData& data) {
+    if(!_putPending || !_putInWriteBuffer) return;
+    // only the value is compared, status and time stamp of the write buffer are the ones of an older read
+    size_t offset = static_cast<char*>(dbr_value_ptr(_pv->value, _pv->dbrType)) - static_cast<char*>(_pv->value);
+    // the subscription might request only the first elements of the array
+    size_t size = std::min<size_t>(data.size, _writeBufferSize);
+    if(size > offset && memcmp(static_cast<const char*>(data.data.get()) + offset,
+                            static_cast<const char*>(_pv->value) + offset, size - offset) == 0) {
+      _putPending = false;
+    }
+  }
+
   bool ChannelInfo::isChannelName(std::string channelName) {
     return _caName.compare(channelName) == 0;
   }
@@ -30,55 +69,87 @@ namespace ChimeraTK {
   }
 
   ChannelManager::~ChannelManager() {
-    std::lock_guard<std::mutex> lock(mapLock);
-    channelMap.clear();
+    cleanup();
   }
 
-  ChannelManager& ChannelManager::getInstance() {
-    static ChannelManager manager;
-    return manager;
+  void ChannelManager::cleanup() {
+    std::unique_lock<std::shared_mutex> lock(mapLock);
+    channelMap.clear();
+    std::lock_guard<std::mutex> stateLockGuard(stateLock);
+    nChannels = 0;
+    nConnected = 0;
+    nMissingInitialValues = 0;
   }
 
   void ChannelManager::channelStateHandler(connection_handler_args args) {
-    auto backend = reinterpret_cast<EpicsBackend*>(ca_puser(args.chid));
+    auto channel = reinterpret_cast<ChannelInfo*>(ca_puser(args.chid));
+    auto backend = channel->_backend;
     if(args.op == CA_OP_CONN_UP) {
       backend->setBackendState(true);
-      std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-      // channel should have been added to the manager - if not let throw here, because this should not happen
-      auto it = ChannelManager::getInstance().findChid(args.chid);
-      it->second._connected = true;
       // configure channel
-      if(!it->second._configured) {
-        it->second._pv->nElems = ca_element_count(args.chid);
-        it->second._pv->dbfType = ca_field_type(args.chid);
-        it->second._pv->dbrType = dbf_type_to_DBR_TIME(it->second._pv->dbfType);
-        it->second._pv->value =
-            calloc(it->second._pv->nElems, dbr_size_n(it->second._pv->dbrType, it->second._pv->nElems));
-        it->second._configured = true;
+      // the value buffer is allocated with the first write, see ChannelInfo::getWriteBuffer()
+      EpicsChannelMetadata metadata;
+      metadata.nElems = ca_element_count(args.chid);
+      metadata.dbfType = ca_field_type(args.chid);
+      metadata.readable = ca_read_access(args.chid) == 1;
+      metadata.writable = ca_write_access(args.chid) == 1;
+      bool layoutChanged = false;
+      {
+        std::lock_guard<std::mutex> lock(channel->_valueLock);
+        if(!channel->_configured) {
+          channel->configure(metadata);
+        }
+        else if(metadata.nElems != channel->_metadata.nElems || metadata.dbfType != channel->_metadata.dbfType) {
+          // configured before, e.g. from an outdated metadata cache - gets and subscriptions with the old layout fail,
+          // so the layout of the server is used and the accessors created before are invalidated
+          channel->configure(metadata);
+          ++channel->_layoutVersion;
+          layoutChanged = true;
+        }
+        else {
+          channel->_metadata.readable = metadata.readable;
+          channel->_metadata.writable = metadata.writable;
+        }
+        channel->_serverMetadata = metadata;
+        channel->_validated = true;
+      }
+      // in partial open mode channels connecting after opening the backend join the async read
+      if(!layoutChanged && backend->_partialOpen && backend->isOpen() && backend->_asyncReadActivated) {
+        try {
+          channel->_manager->activateChannel(channel);
+        }
+        catch(ChimeraTK::runtime_error& e) {
+          std::cerr << e.what() << std::endl;
+        }
+      }
+      channel->_manager->setConnected(channel, true);
+      if(layoutChanged && backend->isOpen()) {
+        // the catalogue and the metadata cache are updated when the backend is opened (again)
+        backend->setException("Type or length of pv " + channel->_caName +
+            " changed. Accessors of its registers have to be recreated.");
       }
     }
     else if(args.op == CA_OP_CONN_DOWN) {
       backend->setBackendState(false);
       if(!backend->isOpen()) {
 #ifdef CHIMERATK_UNITTEST
-        ChannelManager::getInstance().currentState = args.op;
+        currentState = args.op;
 #endif
         return;
       }
-      std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-      // channel should have been added to the manager - if not let throw here, because this should not happen
-      auto it = ChannelManager::getInstance().findChid(args.chid);
-      it->second._connected = false;
-      if(it->second._asyncReadActivated) {
-        ChannelManager::getInstance().deactivateChannels();
-      }
+      channel->_manager->setConnected(channel, false);
+      // only the subscription of this channel is suspended - it is reinstalled by channel access on reconnect
+      channel->_manager->suspendChannel(channel);
 
-      for(auto& accessor : it->second._accessors) {
+      std::lock_guard<std::mutex> lock(channel->_lock);
+      // the last event is outdated and must not be used as initial value after the reconnect
+      channel->_lastEvent = {};
+      for(auto& accessor : channel->_accessors) {
         if(!accessor->_hasNotificationsQueue || !accessor->_backend->_asyncReadActivated) {
           continue;
         }
         try {
-          throw ChimeraTK::runtime_error(std::string("Channel for PV ") + it->second._caName + " was disconnected.");
+          throw ChimeraTK::runtime_error(std::string("Channel for PV ") + channel->_caName + " was disconnected.");
         }
         catch(...) {
           accessor->_notifications.push_overwrite_exception(std::current_exception());
@@ -87,65 +158,201 @@ namespace ChimeraTK {
     }
 #ifdef CHIMERATK_UNITTEST
     // set state -> it is used in the test to wait for a connect/reconnect
-    std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
     if(args.op == CA_OP_CONN_UP) {
-      if(ChannelManager::getInstance().checkAllConnections(true)) {
+      if(channel->_manager->checkAllConnections(true)) {
         // only set connected once all are up
-        ChannelManager::getInstance().currentState = args.op;
+        currentState = args.op;
       }
     }
     else {
-      if(ChannelManager::getInstance().checkAllConnections(false)) {
+      if(channel->_manager->checkAllConnections(false)) {
         // only set connected once all are down and exceptions have been pushed
-        ChannelManager::getInstance().currentState = args.op;
+        currentState = args.op;
       }
     }
 #endif
   }
 
   void ChannelManager::handleEvent(evargs args) {
-    auto base = reinterpret_cast<ChannelManager*>(args.usr);
-    auto backend = reinterpret_cast<EpicsBackend*>(ca_puser(args.chid));
-    std::lock_guard<std::mutex> lock(base->mapLock);
-    auto it = base->findChid(args.chid);
-    if(backend->isOpen() && backend->isFunctional()) {
-      if(it->second._asyncReadActivated) {
-        for(auto& accessor : it->second._accessors) {
-          // channel can have accessors without mode wait_for_new_data -> no notification queue
-          if(accessor->_hasNotificationsQueue) {
-            EpicsRawData data(args);
-            accessor->_notifications.push_overwrite(std::move(data));
-            it->second._initialValueReceived = true;
+    auto channel = reinterpret_cast<ChannelInfo*>(args.usr);
+    auto backend = channel->_backend;
+    if(backend->isOpen()) {
+      // _asyncReadActivated is checked under the lock, because the initial value might arrive before activateChannel()
+      // has set it
+      std::lock_guard<std::mutex> lock(channel->_lock);
+      if(!channel->_subscriptionId) return;
+      if(args.status != ECA_NORMAL || !args.dbr) {
+        // no payload, e.g. if the subscription does not match the layout of the pv anymore
+        std::string error =
+            std::string("Monitor event of pv ") + channel->_caName + " failed: " + ca_message(args.status);
+        std::cerr << error << std::endl;
+        if(!channel->_asyncReadActivated || !backend->isFunctional()) return;
+        for(auto& accessor : channel->_accessors) {
+          if(!accessor->_hasNotificationsQueue) continue;
+          try {
+            throw ChimeraTK::runtime_error(error);
+          }
+          catch(...) {
+            accessor->_notifications.push_overwrite_exception(std::current_exception());
           }
         }
+        return;
+      }
+      // the payload is copied once into a buffer of the pool and shared by all accessors
+      // it is kept as last event also without notification queues, since partial writes use it, and while the
+      // subscription is suspended, since it is used as initial value when the channel is activated again
+      EpicsRawData data(args, getPool(channel, dbr_size_n(args.type, args.count)));
+      data.sequence = ++channel->_nEvents;
+      channel->_lastEvent = data;
+      channel->_lastEventTime = std::chrono::steady_clock::now();
+      {
+        std::lock_guard<std::mutex> valueLock(channel->_valueLock);
+        channel->checkPutReceived(data);
+      }
+      if(!channel->_asyncReadActivated || !backend->isFunctional()) return;
+      if(!channel->_initialValueReceived.exchange(true)) {
+        channel->_manager->updateMissingInitialValues(false);
+      }
+      for(auto& accessor : channel->_accessors) {
+        // channel can have accessors without mode wait_for_new_data -> no notification queue
+        if(accessor->_hasNotificationsQueue) {
+          accessor->pushEvent(data);
+        }
       }
     }
   }
 
-  std::map<std::string, ChannelInfo>::iterator ChannelManager::findChid(const chanId& chid) {
-    for(auto it = channelMap.begin(); it != channelMap.end(); it++) {
-      if(chid == it->second._pv->chid) {
-        return it;
+  EpicsBufferPool& ChannelManager::getPool(ChannelInfo* channel, size_t bufferSize) {
+    if(!channel->_pool || channel->_pool->getBufferSize() != bufferSize) {
+      channel->_pool = std::make_shared<EpicsBufferPool>(bufferSize, getPoolCapacity(channel));
+    }
+    return *channel->_pool;
+  }
+
+  size_t ChannelManager::getSubscriptionElements(ChannelInfo* channel) {
+    // accessors without notification queue are included, since they use the last event for cached reads
+    size_t nElements = 1;
+    for(auto& accessor : channel->_accessors) {
+      nElements = std::max(nElements, accessor->_offsetWords + accessor->_numberOfWords);
+    }
+    return std::min<size_t>(nElements, channel->_pv->nElems);
+  }
+
+  size_t ChannelManager::getPoolCapacity(ChannelInfo* channel) {
+    // one buffer is used to copy the next event, one is held as last event of the channel
+    size_t capacity = 2;
+    size_t losslessCapacity = 0;
+    for(auto& accessor : channel->_accessors) {
+      if(!accessor->_hasNotificationsQueue) continue;
+      // the queue holds one more element than its length, one element is processed by the continuation and one is
+      // kept by the accessor for doPostRead
+      if(accessor->_lossless) {
+        losslessCapacity += accessor->_queueLength + 3;
+      }
+      else {
+        capacity += accessor->_queueLength + 3;
       }
     }
-    throw ChimeraTK::runtime_error("Failed to find channel ID in the channel manager map.");
+    return std::min(capacity, maxPoolCapacity) + losslessCapacity;
+  }
+
+  size_t ChannelManager::getBufferMemory(ChannelInfo* channel) {
+    size_t memory = channel->_writeBufferSize;
+    std::lock_guard<std::mutex> lock(channel->_lock);
+    if(channel->_pool) memory += channel->_pool->getMemory();
+    for(auto& accessor : channel->_accessors) {
+      if(accessor->_readBuffers) memory += accessor->_readBuffers->getMemory();
+    }
+    return memory;
+  }
+
+  size_t ChannelManager::getBufferMemory(const std::string& name) {
+    return getBufferMemory(getChannel(name));
+  }
+
+  size_t ChannelManager::getTotalBufferMemory() {
+    size_t memory = 0;
+    for(auto* ch : getChannels()) {
+      memory += getBufferMemory(ch);
+    }
+    return memory;
+  }
+
+  void ChannelManager::configureChannel(const std::string& name, const EpicsChannelMetadata& metadata) {
+    auto channel = getChannel(name);
+    std::lock_guard<std::mutex> lock(channel->_valueLock);
+    if(!channel->_configured) channel->configure(metadata);
+  }
+
+  bool ChannelManager::getMetadata(const std::string& name, EpicsChannelMetadata& metadata) {
+    auto channel = getChannel(name);
+    std::lock_guard<std::mutex> lock(channel->_valueLock);
+    if(!channel->_configured) return false;
+    metadata = channel->_metadata;
+    return true;
+  }
+
+  bool ChannelManager::getServerMetadata(const std::string& name, EpicsChannelMetadata& metadata) {
+    auto channel = getChannel(name);
+    std::lock_guard<std::mutex> lock(channel->_valueLock);
+    if(!channel->_validated) return false;
+    metadata = channel->_serverMetadata;
+    return true;
   }
 
   std::shared_ptr<pv> ChannelManager::getPV(const std::string& name) {
+    return getChannel(name)->_pv;
+  }
+
+  ChannelInfo* ChannelManager::getChannel(const std::string& name) {
+    std::shared_lock<std::shared_mutex> lock(mapLock);
     if(!channelPresent(name)) {
-      throw ChimeraTK::runtime_error("Tried to get pv without having a map entry!");
+      throw ChimeraTK::runtime_error("Tried to get channel without having a map entry!");
     }
-    return channelMap.find(name)->second._pv;
+    return &channelMap.find(name)->second;
+  }
+
+  std::vector<ChannelInfo*> ChannelManager::getChannels() {
+    std::shared_lock<std::shared_mutex> lock(mapLock);
+    std::vector<ChannelInfo*> channels;
+    channels.reserve(channelMap.size());
+    for(auto& ch : channelMap) {
+      channels.push_back(&ch.second);
+    }
+    return channels;
   }
 
   void ChannelManager::addChannel(const std::string name, EpicsBackend* backend) {
-    if(!channelPresent(name)) {
-      channelMap.insert(std::make_pair(name, ChannelInfo(name)));
+    ChannelInfo* channel;
+    bool inserted;
+    {
+      std::unique_lock<std::shared_mutex> lock(mapLock);
+      auto result = channelMap.try_emplace(name, name);
+      channel = &result.first->second;
+      inserted = result.second;
+      if(inserted) {
+        // counted before creating the channel, since the connection handler might be called before returning
+        std::lock_guard<std::mutex> stateLockGuard(stateLock);
+        ++nChannels;
+      }
     }
-    auto pv = getPV(name);
-    auto result =
-        ca_create_channel(name.c_str(), ChannelManager::channelStateHandler, backend, default_ca_priority, &pv->chid);
+    channel->_backend = backend;
+    channel->_manager = this;
+    channel->_shard = backend->getShard(name);
+    // the channel is created in the context of the calling thread
+    backend->attachContext(channel->_shard);
+    // the ChannelInfo is passed as user pointer - map entries are not moved, so the pointer stays valid
+    auto result = ca_create_channel(
+        name.c_str(), ChannelManager::channelStateHandler, channel, default_ca_priority, &channel->_pv->chid);
     if(result != ECA_NORMAL) {
+      if(inserted) {
+        // the channel will never connect, so waiting for all channels must not wait for it
+        std::unique_lock<std::shared_mutex> lock(mapLock);
+        channelMap.erase(name);
+        std::lock_guard<std::mutex> stateLockGuard(stateLock);
+        --nChannels;
+        stateChanged.notify_all();
+      }
       std::stringstream ss;
       ss << "CA error " << ca_message(result) << " occurred while trying to create channel " << name;
       throw ChimeraTK::runtime_error(ss.str());
@@ -153,33 +360,66 @@ namespace ChimeraTK {
   }
 
   void ChannelManager::addChannelsFromMap(EpicsBackend* backend) {
-    for(auto& ch : channelMap) {
-      auto result = ca_create_channel(ch.second._caName.c_str(), ChannelManager::channelStateHandler, backend,
-          default_ca_priority, &ch.second._pv->chid);
+    for(auto* ch : getChannels()) {
+      ch->_backend = backend;
+      ch->_manager = this;
+      backend->attachContext(ch->_shard);
+      auto result = ca_create_channel(
+          ch->_caName.c_str(), ChannelManager::channelStateHandler, ch, default_ca_priority, &ch->_pv->chid);
       if(result != ECA_NORMAL) {
         std::stringstream ss;
-        ss << "CA error " << ca_message(result) << " occurred while trying to create channel " << ch.second._caName;
+        ss << "CA error " << ca_message(result) << " occurred while trying to create channel " << ch->_caName;
         throw ChimeraTK::runtime_error(ss.str());
       }
     }
   }
 
   bool ChannelManager::checkAllConnections(const bool& connected) {
+    std::lock_guard<std::mutex> lock(stateLock);
     if(connected) {
       // check if all are connected
-      for(auto& ch : channelMap) {
-        if(!ch.second._connected) return false;
-      }
+      return nConnected == nChannels;
     }
-    else {
-      // check if all are disconnected
-      for(auto& ch : channelMap) {
-        if(ch.second._connected) return false;
-      }
+    // check if all are disconnected
+    return nConnected == 0;
+  }
+
+  bool ChannelManager::waitForAllConnections(double timeout) {
+    std::unique_lock<std::mutex> lock(stateLock);
+    return stateChanged.wait_for(
+        lock, std::chrono::duration<double>(timeout), [this] { return nConnected == nChannels; });
+  }
+
+  bool ChannelManager::waitForConnection(const std::string& name, double timeout) {
+    auto channel = getChannel(name);
+    std::unique_lock<std::mutex> lock(stateLock);
+    return stateChanged.wait_for(
+        lock, std::chrono::duration<double>(timeout), [channel] { return channel->_connected.load(); });
+  }
+
+  bool ChannelManager::hasChannel(const std::string& name) {
+    std::shared_lock<std::shared_mutex> lock(mapLock);
+    return channelPresent(name);
+  }
+
+  bool ChannelManager::setConnected(ChannelInfo* channel, bool connected) {
+    std::lock_guard<std::mutex> lock(stateLock);
+    bool previous = channel->_connected.exchange(connected);
+    if(previous != connected) {
+      connected ? ++nConnected : --nConnected;
+      stateChanged.notify_all();
     }
-    return true;
+    return previous;
   }
+
+  void ChannelManager::updateMissingInitialValues(bool increase) {
+    std::lock_guard<std::mutex> lock(stateLock);
+    increase ? ++nMissingInitialValues : --nMissingInitialValues;
+    stateChanged.notify_all();
+  }
+
   bool ChannelManager::isChannelConnected(const std::string name) {
+    std::shared_lock<std::shared_mutex> lock(mapLock);
     if(!channelPresent(name)) return false;
     return channelMap.find(name)->second._connected;
   }
@@ -194,6 +434,7 @@ namespace ChimeraTK {
   }
 
   bool ChannelManager::isChannelConfigured(const std::string& name) {
+    std::shared_lock<std::shared_mutex> lock(mapLock);
     if(channelPresent(name)) {
       return channelMap.find(name)->second._configured;
     }
@@ -203,24 +444,52 @@ namespace ChimeraTK {
   }
 
   void ChannelManager::addAccessor(const std::string& name, EpicsBackendRegisterAccessorBase* accessor) {
-    // map locked by calling function
-    if(!channelPresent(name)) {
-      throw ChimeraTK::runtime_error("Tryed to add an accessor without having a map entry!");
+    ChannelInfo* channel;
+    {
+      std::shared_lock<std::shared_mutex> lock(mapLock);
+      if(!channelPresent(name)) {
+        throw ChimeraTK::runtime_error("Tryed to add an accessor without having a map entry!");
+      }
+      channel = &channelMap.find(name)->second;
     }
-    channelMap.find(name)->second._accessors.push_back(accessor);
-    if(channelMap.find(name)->second._accessors.size() > 1 && channelMap.find(name)->second._asyncReadActivated) {
-      if(accessor->_hasNotificationsQueue) {
-        accessor->setInitialValue(channelMap.find(name)->second._pv->value, channelMap.find(name)->second._pv->dbrType,
-            channelMap.find(name)->second._pv->nElems);
+    bool wasActivated;
+    {
+      std::lock_guard<std::mutex> lock(channel->_lock);
+      channel->_accessors.push_back(accessor);
+      if(channel->_pool) channel->_pool->setCapacity(getPoolCapacity(channel));
+      if(!channel->_subscriptionId || getSubscriptionElements(channel) <= channel->_subscribedElements) {
+        if(channel->_accessors.size() > 1 && channel->_asyncReadActivated) {
+          // the last event might be received by a previous subscription with less elements
+          auto nElements = accessor->_offsetWords + accessor->_numberOfWords;
+          if(accessor->_hasNotificationsQueue && channel->_lastEvent.data && channel->_lastEvent.count >= nElements) {
+            accessor->setInitialValue(channel->_lastEvent);
+          }
+        }
+        return;
       }
+      wasActivated = channel->_asyncReadActivated;
+    }
+    // the accessor needs elements not requested by the subscription: replace it, all accessors receive the value of
+    // the new subscription as initial value
+    deactivateChannel(channel);
+    if(wasActivated) {
+      activateChannel(channel);
+    }
+    else {
+      flush(channel);
     }
   }
 
   void ChannelManager::removeAccessor(const std::string& name, EpicsBackendRegisterAccessorBase* accessor) {
-    std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-    // check if channel is in map -> map might be already cleared.
-    if(channelMap.count(name)) {
-      auto entry = &channelMap.at(name);
+    ChannelInfo* entry;
+    {
+      std::shared_lock<std::shared_mutex> lock(mapLock);
+      // check if channel is in map -> map might be already cleared.
+      if(!channelMap.count(name)) return;
+      entry = &channelMap.at(name);
+    }
+    {
+      std::lock_guard<std::mutex> lock(entry->_lock);
       if(entry->_accessors.size() > 0) {
         bool erased = false;
         for(auto itaccessor = entry->_accessors.begin(); itaccessor != entry->_accessors.end(); ++itaccessor) {
@@ -234,76 +503,150 @@ namespace ChimeraTK {
           std::cout << "Failed to erase accessor for pv:" << name << std::endl;
         }
       }
-      if(entry->_accessors.size() == 0) {
-        if(!entry->_asyncReadActivated) return;
-        ca_clear_subscription(*entry->_subscriptionId);
-        entry->_asyncReadActivated = false;
-        ca_flush_io();
-      }
+      if(entry->_pool) entry->_pool->setCapacity(getPoolCapacity(entry));
+      if(entry->_accessors.size() != 0) return;
     }
+    // accessors might be destroyed after close() destroyed the contexts - there is nothing to flush then
+    if(deactivateChannel(entry) && !entry->_backend->isContextDestroyed()) flush(entry);
   }
 
   void ChannelManager::activateChannel(const std::string& name) {
-    auto pv = getPV(name);
-    activateChannel(&channelMap.find(name)->second);
+    activateChannel(getChannel(name));
   }
 
   void ChannelManager::activateChannel(ChannelInfo* channel) {
+    bool outdated;
+    {
+      std::lock_guard<std::mutex> lock(channel->_lock);
+      outdated = channel->_subscriptionId && channel->_subscribedLayout != channel->_layoutVersion;
+    }
+    // a subscription created with a previous layout of the pv is replaced
+    if(outdated) deactivateChannel(channel);
+    std::lock_guard<std::mutex> lock(channel->_lock);
     if(channel->_asyncReadActivated) return;
     // only open subscription if accessors are present -> else the initial value will be lost
     // The handler will be called directly after creating the subscription
     // E.g. in case of QtHardmon EpicsBackend::activateAsyncRead is called first and accessors are added later
     if(channel->_accessors.size() == 0) return;
+    if(channel->_subscriptionId) {
+      // resume suspended subscription
+      channel->_asyncReadActivated = true;
+      // the last event might be received by a previous subscription with less elements
+      if(channel->_connected && channel->_lastEvent.data && channel->_lastEvent.count >= channel->_subscribedElements) {
+        channel->_initialValueReceived = true;
+        for(auto& accessor : channel->_accessors) {
+          if(accessor->_hasNotificationsQueue) accessor->setInitialValue(channel->_lastEvent);
+        }
+      }
+      else {
+        channel->_initialValueReceived = false;
+        updateMissingInitialValues(true);
+      }
+      return;
+    }
     channel->_subscriptionId = new evid();
-    auto ret = ca_create_subscription(channel->_pv->dbrType, channel->_pv->nElems, channel->_pv->chid, DBE_VALUE,
-        &ChannelManager::handleEvent, static_cast<ChannelManager*>(this), channel->_subscriptionId);
+    channel->_subscribedElements = getSubscriptionElements(channel);
+    channel->_subscribedLayout = channel->_layoutVersion;
+    auto ret = ca_create_subscription(channel->_pv->dbrType, channel->_subscribedElements, channel->_pv->chid,
+        DBE_VALUE, &ChannelManager::handleEvent, channel, channel->_subscriptionId);
     if(ret != ECA_NORMAL) {
-      throw ChimeraTK::runtime_error(std::string("Failed to create subscription for channel: ") + channel->_pv->name);
+      // the channel is not subscribed, so the next activation creates the subscription again
+      delete channel->_subscriptionId;
+      channel->_subscriptionId = nullptr;
+      channel->_subscribedElements = 0;
+      throw ChimeraTK::runtime_error(std::string("Failed to create subscription for channel: ") + channel->_pv->name +
+          " (" + ca_message(ret) + ")");
     }
-    ca_flush_io();
+    flush(channel);
     channel->_asyncReadActivated = true;
     channel->_initialValueReceived = false;
+    updateMissingInitialValues(true);
     std::cout << "Channel " << channel->_caName << " activated for async read." << std::endl;
   }
 
-  void ChannelManager::activateChannels() {
-    for(auto& ch : channelMap) {
-      activateChannel(&ch.second);
+  bool ChannelManager::deactivateChannel(ChannelInfo* channel) {
+    evid* subscriptionId;
+    {
+      std::lock_guard<std::mutex> lock(channel->_lock);
+      if(!channel->_subscriptionId) return false;
+      if(channel->_asyncReadActivated.exchange(false) && !channel->_initialValueReceived) {
+        updateMissingInitialValues(false);
+      }
+      subscriptionId = std::exchange(channel->_subscriptionId, nullptr);
     }
+    // not done under the channel lock: clearing waits for a running subscription callback, which needs the lock
+    ca_clear_subscription(*subscriptionId);
+    delete subscriptionId;
+    return true;
   }
 
-  bool ChannelManager::checkInitialValueReceived() {
-    std::lock_guard<std::mutex> lock(ChannelManager::getInstance().mapLock);
-    for(auto& ch : channelMap) {
-      if(ch.second._asyncReadActivated && !ch.second._initialValueReceived) return false;
+  void ChannelManager::suspendChannel(ChannelInfo* channel) {
+    std::lock_guard<std::mutex> lock(channel->_lock);
+    if(channel->_asyncReadActivated.exchange(false) && !channel->_initialValueReceived) {
+      updateMissingInitialValues(false);
     }
-    return true;
+  }
+
+  void ChannelManager::suspendChannels() {
+    for(auto* ch : getChannels()) {
+      suspendChannel(ch);
+    }
+  }
+
+  void ChannelManager::activateChannels(bool connectedOnly) {
+    for(auto* ch : getChannels()) {
+      if(connectedOnly && !ch->_connected) continue;
+      activateChannel(ch);
+    }
+  }
+
+  bool ChannelManager::checkInitialValueReceived() {
+    std::lock_guard<std::mutex> lock(stateLock);
+    return nMissingInitialValues == 0;
+  }
+
+  bool ChannelManager::waitForInitialValues(double timeout) {
+    std::unique_lock<std::mutex> lock(stateLock);
+    return stateChanged.wait_for(
+        lock, std::chrono::duration<double>(timeout), [this] { return nMissingInitialValues == 0; });
   }
 
   void ChannelManager::deactivateChannels() {
-    for(auto& ch : channelMap) {
-      if(!ch.second._asyncReadActivated) continue;
-      ca_clear_subscription(*ch.second._subscriptionId);
-      ch.second._asyncReadActivated = false;
+    auto channels = getChannels();
+    for(auto* ch : channels) {
+      deactivateChannel(ch);
     }
+    // all channels belong to the same backend
+    if(!channels.empty()) channels.front()->_backend->flushIO();
+  }
+
+  void ChannelManager::flush(ChannelInfo* channel) {
+    // in the callbacks the thread is attached to the context of the channel already
+    channel->_backend->attachContext(channel->_shard);
     ca_flush_io();
   }
 
+  void ChannelManager::updateConnectionState() {
+    for(auto* ch : getChannels()) {
+      setConnected(ch, ca_state(ch->_pv->chid) == cs_conn);
+    }
+  }
+
   void ChannelManager::resetConnectionState() {
-    for(auto& ch : channelMap) {
-      ch.second._connected = false;
+    for(auto* ch : getChannels()) {
+      setConnected(ch, false);
     }
   }
 
   void ChannelManager::setException(const std::string error) {
-    std::lock_guard<std::mutex> lock(mapLock);
-    ChannelManager::getInstance().deactivateChannels();
-    for(auto& mapItem : channelMap) {
+    // subscriptions are kept, so recovering only needs to resubscribe channels that were disconnected
+    suspendChannels();
+    for(auto* ch : getChannels()) {
       // only push exceptions to channels that are still connected
       // if an exception is see on the first channel it is push to the notification queue and _connected is set false.
-      if(mapItem.second._connected) {
-        mapItem.second._connected = false;
-        for(auto& accessor : mapItem.second._accessors) {
+      if(setConnected(ch, false)) {
+        std::lock_guard<std::mutex> lock(ch->_lock);
+        for(auto& accessor : ch->_accessors) {
           try {
             throw ChimeraTK::runtime_error(error);
           }
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/*
+ * EPICSGetTracker.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "EPICSGetTracker.h"
+
+#include <ChimeraTK/Exception.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring> // memcpy
+
+namespace ChimeraTK {
+
+  int EpicsGetTracker::get(
+      long type, unsigned long count, chanId chid, std::shared_ptr<void> buffer, const std::string& name) {
+    size_t id;
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      id = _nextId++;
+      _pending[id] = name;
+    }
+    auto request = new Request{shared_from_this(), id, std::move(buffer), dbr_size_n(type, count)};
+    auto result = ca_array_get_callback(type, count, chid, &EpicsGetTracker::getHandler, request);
+    if(result != ECA_NORMAL) {
+      // the handler is not called in this case
+      delete request;
+      complete(id, result);
+    }
+    return result;
+  }
+
+  void EpicsGetTracker::getHandler(evargs args) {
+    auto request = reinterpret_cast<Request*>(args.usr);
+    auto status = args.status;
+    if(status == ECA_NORMAL && args.dbr) {
+      memcpy(request->buffer.get(), args.dbr, std::min<size_t>(request->size, dbr_size_n(args.type, args.count)));
+    }
+    else if(status == ECA_NORMAL) {
+      status = ECA_GETFAIL;
+    }
+    request->tracker->complete(request->id, status);
+    delete request;
+  }
+
+  void EpicsGetTracker::complete(size_t id, int status) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _pending.find(id);
+    if(status != ECA_NORMAL) {
+      _errors[it->second] = ca_message(status);
+    }
+    _pending.erase(it);
+    _cv.notify_all();
+  }
+
+  bool EpicsGetTracker::wait(double timeout) {
+    std::unique_lock<std::mutex> lock(_lock);
+    return _cv.wait_for(lock, std::chrono::duration<double>(timeout), [this] { return _pending.empty(); });
+  }
+
+  void EpicsGetTracker::checkErrors() {
+    std::lock_guard<std::mutex> lock(_lock);
+    if(_errors.empty() && _pending.empty()) return;
+    std::string message;
+    for(auto& error : _errors) {
+      message += (message.empty() ? "" : ", ") + std::string("Failed to read pv: ") + error.first + " (" +
+          error.second + ")";
+    }
+    for(auto& pending : _pending) {
+      message += (message.empty() ? "" : ", ") + std::string("Read operation timed out for pv: ") + pending.second;
+    }
+    throw ChimeraTK::runtime_error(message);
+  }
+
+} // namespace ChimeraTK
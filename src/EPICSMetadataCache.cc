@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/*
+ * EPICSMetadataCache.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "EPICSMetadataCache.h"
+
+#include <ChimeraTK/Exception.h>
+
+#include <cstdio> // std::rename
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace ChimeraTK {
+
+  EpicsMetadataCache::EpicsMetadataCache(const std::string& fileName, const std::string& mapFile)
+  : _fileName(fileName), _mapFile(mapFile) {
+    std::ifstream file(_fileName);
+    if(!file.is_open()) {
+      // no cache yet - it is written once the channels are connected
+      _changed = true;
+      return;
+    }
+    std::string line;
+    if(!std::getline(file, line) || line != "# map " + _mapFile) {
+      std::cerr << "Metadata cache " << _fileName << " was written for another map file and is ignored." << std::endl;
+      _changed = true;
+      return;
+    }
+    while(std::getline(file, line)) {
+      std::istringstream ss(line);
+      std::string name;
+      EpicsChannelMetadata metadata;
+      if(!(ss >> name >> metadata.nElems >> metadata.dbfType >> metadata.readable >> metadata.writable)) {
+        std::cerr << "Failed reading the following line from metadata cache " << _fileName
+                  << " (-> line is ignored): \n " << line << std::endl;
+        _changed = true;
+        continue;
+      }
+      _entries[name] = metadata;
+    }
+  }
+
+  bool EpicsMetadataCache::get(const std::string& pvName, EpicsChannelMetadata& metadata) const {
+    auto it = _entries.find(pvName);
+    if(it == _entries.end()) return false;
+    metadata = it->second;
+    return true;
+  }
+
+  void EpicsMetadataCache::set(const std::string& pvName, const EpicsChannelMetadata& metadata) {
+    auto it = _entries.find(pvName);
+    if(it != _entries.end() && it->second == metadata) return;
+    _entries[pvName] = metadata;
+    _changed = true;
+  }
+
+  void EpicsMetadataCache::save() {
+    if(!_changed) return;
+    std::string tmpName = _fileName + ".tmp";
+    {
+      std::ofstream file(tmpName, std::ios::trunc);
+      if(!file.is_open()) {
+        throw ChimeraTK::runtime_error("Failed writing metadata cache: " + tmpName);
+      }
+      file << "# map " << _mapFile << "\n";
+      for(auto& entry : _entries) {
+        file << entry.first << " " << entry.second.nElems << " " << entry.second.dbfType << " "
+             << entry.second.readable << " " << entry.second.writable << "\n";
+      }
+      if(!file.good()) {
+        throw ChimeraTK::runtime_error("Failed writing metadata cache: " + tmpName);
+      }
+    }
+    if(std::rename(tmpName.c_str(), _fileName.c_str()) != 0) {
+      throw ChimeraTK::runtime_error("Failed replacing metadata cache: " + _fileName);
+    }
+    _changed = false;
+  }
+
+} // namespace ChimeraTK
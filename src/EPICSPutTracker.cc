@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/*
+ * EPICSPutTracker.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "EPICSPutTracker.h"
+
+#include <ChimeraTK/Exception.h>
+
+#include <chrono>
+
+namespace ChimeraTK {
+
+  int EpicsPutTracker::put(long type, unsigned long count, chanId chid, const void* value, const std::string& name) {
+    if(!_callback) {
+      auto result = ca_array_put(type, count, chid, value);
+      if(result != ECA_NORMAL) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _errors[name] = ca_message(result);
+      }
+      return result;
+    }
+    size_t id;
+    {
+      std::lock_guard<std::mutex> lock(_lock);
+      id = _nextId++;
+      _pending[id] = name;
+    }
+    auto request = new Request{shared_from_this(), id};
+    auto result = ca_array_put_callback(type, count, chid, value, &EpicsPutTracker::putHandler, request);
+    if(result != ECA_NORMAL) {
+      // the handler is not called in this case
+      delete request;
+      complete(id, result);
+    }
+    return result;
+  }
+
+  void EpicsPutTracker::putHandler(evargs args) {
+    auto request = reinterpret_cast<Request*>(args.usr);
+    request->tracker->complete(request->id, args.status);
+    delete request;
+  }
+
+  void EpicsPutTracker::complete(size_t id, int status) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _pending.find(id);
+    if(status != ECA_NORMAL) {
+      _errors[it->second] = ca_message(status);
+    }
+    _pending.erase(it);
+    _cv.notify_all();
+  }
+
+  bool EpicsPutTracker::wait(double timeout) {
+    return waitForCapacity(1, timeout);
+  }
+
+  bool EpicsPutTracker::waitForCapacity(size_t maxPending, double timeout) {
+    std::unique_lock<std::mutex> lock(_lock);
+    return _cv.wait_for(
+        lock, std::chrono::duration<double>(timeout), [this, maxPending] { return _pending.size() < maxPending; });
+  }
+
+  void EpicsPutTracker::checkErrors() {
+    std::lock_guard<std::mutex> lock(_lock);
+    if(_errors.empty() && _pending.empty()) return;
+    std::string message;
+    for(auto& error : _errors) {
+      message += (message.empty() ? "" : ", ") + std::string("Failed to write pv: ") + error.first + " (" +
+          error.second + ")";
+    }
+    for(auto& pending : _pending) {
+      message += (message.empty() ? "" : ", ") + std::string("Timeout while writing pv: ") + pending.second;
+    }
+    throw ChimeraTK::runtime_error(message);
+  }
+
+  std::string EpicsPutTracker::takeError(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _errors.find(name);
+    if(it == _errors.end()) return {};
+    auto error = std::move(it->second);
+    _errors.erase(it);
+    return error;
+  }
+
+} // namespace ChimeraTK
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: Helmholtz-Zentrum Dresden-Rossendorf, FWKE, ChimeraTK Project <chimeratk-support@desy.de>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/*
+ * EPICSTransferBatch.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "EPICSTransferBatch.h"
+
+#include "EPICSBackendRegisterAccessor.h"
+
+#include <algorithm>
+
+namespace ChimeraTK {
+
+  EpicsTransferBatch::EpicsTransferBatch(boost::shared_ptr<EpicsBackend> backend)
+  : TransferElement("EpicsTransferBatch", {}), _backend(backend) {
+    _exceptionBackend = backend;
+  }
+
+  void EpicsTransferBatch::add(EpicsBackendRegisterAccessorBase* accessor) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _accessors.push_back(accessor);
+  }
+
+  void EpicsTransferBatch::remove(EpicsBackendRegisterAccessorBase* accessor) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _accessors.erase(std::remove(_accessors.begin(), _accessors.end(), accessor), _accessors.end());
+  }
+
+  void EpicsTransferBatch::merge(EpicsTransferBatch& other) {
+    auto self = boost::static_pointer_cast<EpicsTransferBatch>(shared_from_this());
+    std::scoped_lock lock(_lock, other._lock);
+    for(auto accessor : other._accessors) {
+      accessor->_batch = self;
+      _accessors.push_back(accessor);
+    }
+    other._accessors.clear();
+  }
+
+  void EpicsTransferBatch::doReadTransferSynchronously() {
+    _backend->checkActiveException();
+    std::lock_guard<std::mutex> lock(_lock);
+    if(_accessors.empty()) return;
+    for(auto accessor : _accessors) {
+      accessor->checkLayout();
+      accessor->checkAsyncWriteError();
+    }
+    std::vector<EpicsBackendRegisterAccessorBase*> requested;
+    auto tracker = std::make_shared<EpicsGetTracker>();
+    try {
+      for(auto accessor : _accessors) {
+        if(accessor->readCachedValue()) continue;
+        accessor->requestRead(*tracker);
+        requested.push_back(accessor);
+      }
+    }
+    catch(ChimeraTK::runtime_error&) {
+      // send the gets already requested - pending gets keep their buffers, so later reads are not affected
+      _backend->flushIO();
+      throw;
+    }
+    if(requested.empty()) return;
+    _backend->flushIO();
+    tracker->wait(default_ca_timeout);
+    tracker->checkErrors();
+    for(auto accessor : requested) {
+      accessor->finishRead();
+    }
+  }
+
+  bool EpicsTransferBatch::doWriteTransfer(VersionNumber /*versionNumber*/) {
+    _backend->checkActiveException();
+    std::lock_guard<std::mutex> lock(_lock);
+    auto unconfirmed = std::make_shared<EpicsPutTracker>(false);
+    auto confirmed = std::make_shared<EpicsPutTracker>();
+    bool hasConfirmedWrites = false;
+    try {
+      for(auto accessor : _accessors) {
+        if(!accessor->_info._isWritable) continue;
+        accessor->checkLayout();
+        accessor->checkAsyncWriteError();
+        if(accessor->_info._writeMode == EpicsWriteMode::async) {
+          accessor->requestAsyncWrite();
+        }
+        else if(accessor->_info._writeMode == EpicsWriteMode::confirmed) {
+          accessor->requestWrite(*confirmed);
+          hasConfirmedWrites = true;
+        }
+        else {
+          accessor->requestWrite(*unconfirmed);
+        }
+      }
+    }
+    catch(ChimeraTK::runtime_error&) {
+      // send the puts already requested, so the result does not depend on later transfers
+      _backend->flushIO();
+      throw;
+    }
+    _backend->flushIO();
+    if(hasConfirmedWrites) confirmed->wait(default_ca_timeout);
+    unconfirmed->checkErrors();
+    confirmed->checkErrors();
+    return true;
+  }
+
+} // namespace ChimeraTK
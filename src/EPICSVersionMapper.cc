@@ -9,13 +9,70 @@
 
 #include "EPICSVersionMapper.h"
 
+namespace {
+  /**
+   * Mix the bits of the time stamp, since the lower bits of the nanoseconds are often zero.
+   */
+  uint64_t hashTimeStamp(int64_t timeStamp) {
+    auto x = static_cast<uint64_t>(timeStamp);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+} // namespace
+
 ChimeraTK::VersionNumber EPICS::VersionMapper::getVersion(const epicsTimeStamp& timeStamp) {
-  std::lock_guard<std::mutex> lock(_mapMutex);
-  int64_t timeStampEPOCH = (_epicsTimeOffset + timeStamp.secPastEpoch) * 1e9 + timeStamp.nsec;
-  if(!_versionMap.count(timeStampEPOCH)) {
-    if(_versionMap.size() == maxSizeEventIdMap) _versionMap.erase(_versionMap.begin());
-    std::chrono::duration<int64_t, std::nano> tp(timeStampEPOCH);
-    _versionMap[timeStampEPOCH] = ChimeraTK::VersionNumber(timePoint_t(tp));
+  // integer arithmetic - a double can not represent nanoseconds since 1970 exactly
+  int64_t timeStampEPOCH = (_epicsTimeOffset + timeStamp.secPastEpoch) * 1000000000LL + timeStamp.nsec;
+  auto hash = hashTimeStamp(timeStampEPOCH);
+  auto& shard = _shards[hash % nShards];
+  constexpr size_t mask = tableSize - 1;
+  size_t index = (hash / nShards) & mask;
+  std::lock_guard<std::mutex> lock(shard.lock);
+  for(; shard.table[index].used; index = (index + 1) & mask) {
+    if(shard.table[index].timeStamp == timeStampEPOCH) return shard.table[index].version;
+  }
+  if(shard.size == ringSize) {
+    // replace the oldest time stamp of the shard
+    auto oldest = shard.ring[shard.next];
+    auto oldestHash = hashTimeStamp(oldest);
+    size_t oldestIndex = (oldestHash / nShards) & mask;
+    while(shard.table[oldestIndex].timeStamp != oldest) oldestIndex = (oldestIndex + 1) & mask;
+    shard.erase(oldestIndex);
+    // the free entry found above might have been moved
+    index = (hash / nShards) & mask;
+    while(shard.table[index].used) index = (index + 1) & mask;
+  }
+  else {
+    ++shard.size;
+  }
+  shard.ring[shard.next] = timeStampEPOCH;
+  shard.next = (shard.next + 1) % ringSize;
+  auto& entry = shard.table[index];
+  entry.timeStamp = timeStampEPOCH;
+  entry.used = true;
+  std::chrono::duration<int64_t, std::nano> tp(timeStampEPOCH);
+  entry.version = ChimeraTK::VersionNumber(timePoint_t(tp));
+  return entry.version;
+}
+
+void EPICS::VersionMapper::Shard::erase(size_t index) {
+  constexpr size_t mask = tableSize - 1;
+  size_t next = index;
+  while(true) {
+    table[index].used = false;
+    while(true) {
+      next = (next + 1) & mask;
+      if(!table[next].used) return;
+      size_t home = (hashTimeStamp(table[next].timeStamp) / nShards) & mask;
+      // the entry can not be moved before its home position
+      bool stays = index <= next ? (index < home && home <= next) : (index < home || home <= next);
+      if(!stays) break;
+    }
+    table[index] = table[next];
+    index = next;
   }
-  return _versionMap[timeStampEPOCH];
 }